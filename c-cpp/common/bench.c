@@ -0,0 +1,4215 @@
+/*
+ * File:
+ *   bench.c
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Benchmark driver shared by all data structures: option parsing,
+ *   population, concurrent accesses and statistics.
+ *
+ * Copyright (c) 2026.
+ *
+ * bench.c is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE	/* sched_setaffinity() and CPU_* */
+#endif
+#include <assert.h>
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include <atomic_ops.h>
+
+#include "bench.h"
+
+#define DEFAULT_DURATION                10000
+#define DEFAULT_INITIAL                 256
+#define DEFAULT_NB_THREADS              1
+#define DEFAULT_RANGE                   0x7FFFFFFF
+#define DEFAULT_SEED                    0
+#define DEFAULT_UPDATE                  20
+#define DEFAULT_MOVE                    0
+#define DEFAULT_SNAPSHOT                0
+#define DEFAULT_RANGE_RATE              0
+#define DEFAULT_RANGE_LENGTH            100
+#define DEFAULT_VALUE_SIZE              0
+#define DEFAULT_OVERWRITE               0
+#define MAX_VALUE_SIZE                  1024
+#define DEFAULT_ELASTICITY              4
+#define DEFAULT_ALTERNATE               0
+#define DEFAULT_EFFECTIVE               1
+#define DEFAULT_UNBALANCED              0
+#define DEFAULT_LATENCY                 0
+#define DEFAULT_ZIPF_THETA              0.99
+#define DEFAULT_HOT_OPS                 90
+#define DEFAULT_HOT_KEYS                10
+#define DEFAULT_KEY_BUFFER              0
+#define DEFAULT_INTERVAL                0
+#define DEFAULT_OP_COUNT                0
+#define DEFAULT_RATE                    0
+#define DEFAULT_PREFILL                 0
+
+/* Synchronization flavor the driver was built for, as set by Makefile.common */
+#if defined(ESTM)
+# define BENCH_FLAVOR                   "ESTM"
+#elif defined(TINY100) || defined(TINY10B) || defined(TINY099) || defined(TINY098)
+# define BENCH_FLAVOR                   "TINYSTM"
+#elif defined(TL2)
+# define BENCH_FLAVOR                   "TL2"
+#elif defined(WLPDSTM)
+# define BENCH_FLAVOR                   "WLPDSTM"
+#elif defined(SEQUENTIAL)
+# define BENCH_FLAVOR                   "SEQUENTIAL"
+#elif defined(LOCKFREE)
+# define BENCH_FLAVOR                   "LOCKFREE"
+#elif defined(MUTEX)
+# define BENCH_FLAVOR                   "MUTEX"
+#else
+# define BENCH_FLAVOR                   "SPIN"
+#endif
+
+#define XSTR(s)                         STR(s)
+#define STR(s)                          #s
+
+/*
+ * Latency histograms are log-linear, HDR-style: values below HIST_SUB are
+ * recorded exactly, larger ones in one of HIST_SUB buckets per power of
+ * two, so each percentile is within 1/HIST_SUB (~3%) of the true value.
+ */
+#define HIST_SUB_BITS                   5
+#define HIST_SUB                        (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS                    ((64 - HIST_SUB_BITS + 1) << HIST_SUB_BITS)
+
+/* Common options, structure-specific ones are appended at runtime */
+#define BENCH_OPTSTRING                 "hAf:d:i:t:n:r:S:u:x:U:mvb:B:L:D:K:P:G:I:o:O:EN:W:R:Q:J:F:YXCT:M:y:g:"
+#define BENCH_MAX_OPTIONS               56
+
+/* Below this, a paced thread spins rather than sleeps until its next op */
+#define PACE_SPIN_NS                    50000
+
+static volatile AO_t stop;
+/* Threads still in their timed loop */
+static volatile AO_t nb_running;
+/* Threads stop by themselves, after -N operations or their -R stream */
+static int fixed_ops;
+
+/* Preemption of lock holders (-y): one in every, for preempt_us or a yield */
+int bench_preempt_every;
+static int preempt_us;
+static __thread thread_data_t *preempt_self;	/* NULL but in workers */
+
+/* Time the initial population took */
+static uint64_t prefill_ns;
+
+/* Period at which the main thread samples the footprint during the run */
+#define MEM_SAMPLE_MS                   100
+
+/* Process footprint in bytes: resident set, and heap in use if known */
+typedef struct mem_usage {
+	long rss;
+	long heap;
+} mem_usage_t;
+
+static mem_usage_t mem_base;		/* before the set is created */
+static mem_usage_t mem_populated;
+static long populated_size;
+static mem_usage_t mem_peak;		/* highest sampled during the run */
+static mem_usage_t mem_end;
+static bench_mem_t set_mem;		/* counted by the structure at the end */
+
+/*
+ * Blocks the nodes of a bulk-built set are carved from, each twice as
+ * large as the previous one so that a few hold any set.
+ */
+#define BULK_BLOCK                      (1 << 20)
+#define BULK_MAX_BLOCKS                 40
+
+typedef struct bulk_block {
+	char *base;
+	char *next;
+	char *end;
+} bulk_block_t;
+
+static bulk_block_t bulk_blocks[BULK_MAX_BLOCKS];
+static int bulk_nb_blocks;
+
+/* Trace being replayed (-R), mapped read-only and shared by the threads */
+static void *trace_map;
+static size_t trace_size;
+
+/* Keys whose linearization search gives up, -C, after this many states */
+#define CHECK_MAX_STATES                (1L << 22)
+/* Events printed per key found not linearizable */
+#define CHECK_REPORT_EVENTS             16
+#define CHECK_REPORT_KEYS               4
+
+/* Operation types, latency is recorded per type and outcome; same codes as TRACE_* */
+enum { OP_ADD, OP_REMOVE, OP_CONTAINS, OP_MOVE, OP_SNAPSHOT, OP_RANGE, OP_OVERWRITE, NB_OPS };
+
+static const char *op_names[NB_OPS] = {
+	"add", "remove", "contains", "move", "snapshot", "range", "overwrite"
+};
+
+/* Arrival processes of the open-loop mode (-J) */
+enum { ARRIVAL_CONSTANT, ARRIVAL_POISSON };
+
+static const char *arrival_names[] = {
+	"constant", "poisson"
+};
+
+static const char *dist_names[] = {
+	"uniform", "zipf", "hotspot", "sequential", "latest"
+};
+
+/* Hardware and software events counted per thread (-E) */
+enum {
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_L1D_MISSES,
+	PERF_LLC_MISSES,
+	PERF_BRANCH_MISSES,
+	PERF_CTX_SWITCHES,
+	NB_PERF
+};
+
+static const char *perf_names[NB_PERF] = {
+	"cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses",
+	"ctx-switches"
+};
+
+/* Counts of the timed phase, PERF_NA for events that could not be opened */
+#define PERF_NA                         (~(uint64_t)0)
+
+typedef struct bench_perf {
+	int fd[NB_PERF];
+	uint64_t count[NB_PERF];
+} bench_perf_t;
+
+/* Result record formats (-o) */
+enum { OUT_NONE, OUT_JSON, OUT_CSV };
+
+static const char *out_names[] = {
+	"none", "json", "csv"
+};
+
+/*
+ * Key distribution, read-only once the threads run. Zipf draws use the
+ * method of Gray et al. (SIGMOD'94), as YCSB does: zeta(n, theta) and
+ * the other constants are computed once so that a draw costs one pow().
+ */
+typedef struct key_dist {
+	int type;
+	long range;
+	double theta;
+	double alpha;
+	double zetan;
+	double eta;
+	double zeta2_bound;
+	int hot_ops;
+	long hot_keys;
+	long shift;	/* keys drawn move up by shift, wrapping around */
+} key_dist_t;
+
+static key_dist_t dist;
+
+#define MAX_PHASES                      256
+#define PHASE_LINE                      256
+#define PHASE_PARK_NS                   100000
+
+/*
+ * Phase of the workload script (-T): its settings, then what the main
+ * thread measured over it.
+ */
+typedef struct phase {
+	int duration;		/* ms */
+	int update;
+	int nb_threads;		/* threads with a higher id are parked */
+	int offset;		/* % of the range the keys move up by */
+	char dist_name[32];
+	key_dist_t dist;
+	uint64_t ns;		/* measured, 0 until the phase is over */
+	unsigned long ops;
+	unsigned long upd;
+	uint64_t p50;
+	uint64_t p99;
+} phase_t;
+
+static phase_t *phases;
+static int nb_phases;
+static volatile AO_t phase_cur;	/* phase the workers run */
+static uint64_t phase_start_ns;	/* when the main thread started it */
+static uint64_t phase_end;	/* when it is due to end */
+static unsigned long phase_ops, phase_upd;	/* counts when it began */
+static struct bench_hist *phase_lat;	/* latencies when it began, then of it */
+
+/* Thread placement policies (-P) */
+enum { PIN_NONE, PIN_COMPACT, PIN_SCATTER, PIN_SMT, PIN_LIST };
+
+static const char *pin_names[] = {
+	"none", "compact", "scatter", "smt"
+};
+
+typedef struct cpu_topo {
+	int cpu;
+	int pkg;	/* socket */
+	int core;	/* rank of the core within its socket */
+	int smt;	/* rank of the hardware thread within its core */
+} cpu_topo_t;
+
+/*
+ * CPUs of the workers and of the background threads, in assignment
+ * order: worker i runs on pin_cpus[i % pin_ncpus]. Read-only once the
+ * threads run, except for the background thread counter.
+ */
+static int *pin_cpus, *pin_bg_cpus;
+static int pin_ncpus, pin_bg_ncpus;
+static volatile AO_t pin_bg_next;
+
+typedef struct bench_hist {
+	unsigned long count;
+	uint64_t min;
+	uint64_t max;
+	unsigned long buckets[HIST_BUCKETS];
+} bench_hist_t;
+
+/* Spins before yielding the CPU while waiting at a barrier */
+#define BARRIER_SPINS                   1024
+
+void barrier_init(barrier_t *b, int n)
+{
+	b->count = n;
+	b->sense = 0;
+	b->n = n;
+}
+
+/*
+ * Sense-reversing barrier: the last thread in resets the count and flips
+ * the sense, which the others spin on, so that they all leave within a
+ * cache miss of each other rather than of a futex wake-up each. Waiters
+ * yield now and then in case there are more threads than CPUs.
+ */
+void barrier_cross(barrier_t *b)
+{
+	AO_t sense = !AO_load_full(&b->sense);
+	int spins = 0;
+
+	if (AO_fetch_and_sub1_full(&b->count) == 1) {
+		AO_store(&b->count, b->n);
+		AO_store_full(&b->sense, sense);
+		return;
+	}
+	while (AO_load_full(&b->sense) != sense) {
+		if (++spins == BARRIER_SPINS) {
+			sched_yield();
+			spins = 0;
+		}
+	}
+}
+
+/*
+ * Per-thread xorshift128+ generator (Vigna, 2014): a few shifts and an
+ * add per 64-bit value, where rand_r() only yields 31 bits and needed a
+ * floating-point scaling loop to cover ranges wider than RAND_MAX.
+ */
+static inline uint64_t rand_next(bench_rng_t *rng)
+{
+	uint64_t s1 = rng->s[0];
+	const uint64_t s0 = rng->s[1];
+
+	rng->s[0] = s0;
+	s1 ^= s1 << 23;
+	rng->s[1] = s1 ^ s0 ^ (s1 >> 18) ^ (s0 >> 5);
+	return rng->s[1] + s0;
+}
+
+/*
+ * Expands the run seed into the state of one of its streams with
+ * splitmix64. Threads get their own stream, independent of any rand()
+ * call of the data structures, so that -S reproduces their operations.
+ */
+static void rand_init(bench_rng_t *rng, unsigned int seed, unsigned int stream)
+{
+	uint64_t z, x = ((uint64_t)stream << 32) | seed;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		z = (x += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		rng->s[i] = z ^ (z >> 31);
+	}
+}
+
+/*
+ * Returns an unbiased pseudo-random value in [0; n), n > 0, with
+ * Lemire's multiply-shift reduction ("Fast random integer generation in
+ * an interval", 2019): the division only runs on the rare rejections.
+ */
+static inline uint64_t rand_below(bench_rng_t *rng, uint64_t n)
+{
+#ifdef __SIZEOF_INT128__
+	unsigned __int128 m = (unsigned __int128)rand_next(rng) * n;
+	uint64_t l = (uint64_t)m, t;
+
+	if (l < n) {
+		t = -n % n;
+		while (l < t) {
+			m = (unsigned __int128)rand_next(rng) * n;
+			l = (uint64_t)m;
+		}
+	}
+	return (uint64_t)(m >> 64);
+#else
+	uint64_t x, t = -n % n;
+
+	do {
+		x = rand_next(rng);
+	} while (x < t);
+	return x % n;
+#endif
+}
+
+/* Returns a pseudo-random value in [1; r] */
+static inline long rand_range_re(bench_rng_t *rng, long r)
+{
+	return 1 + (long)rand_below(rng, (uint64_t)r);
+}
+
+/* Returns a pseudo-random value in [0; 1) */
+static inline double rand_unit_re(bench_rng_t *rng)
+{
+	return (rand_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * zeta(n, theta) = sum_{i=1}^{n} 1/i^theta, summed exactly over the first
+ * terms and approximated by the integral of the tail beyond, which is
+ * accurate to well below 0.1% and keeps start-up fast for 2^31 keys.
+ */
+static double zeta(long n, double theta)
+{
+	const long exact = 1000000;
+	long i, m = (n < exact ? n : exact);
+	double sum = 0;
+
+	for (i = 1; i <= m; i++)
+		sum += pow((double)i, -theta);
+	if (n > m)
+		sum += (pow(n + 0.5, 1 - theta) - pow(m + 0.5, 1 - theta)) / (1 - theta);
+	return sum;
+}
+
+static void dist_init(key_dist_t *kd, const bench_config_t *cfg)
+{
+	double zeta2;
+
+	kd->type = cfg->dist;
+	kd->range = cfg->range;
+	kd->theta = cfg->theta;
+	if (kd->type == DIST_ZIPF || kd->type == DIST_LATEST) {
+		zeta2 = zeta(2, kd->theta);
+		kd->alpha = 1.0 / (1.0 - kd->theta);
+		kd->zetan = zeta(kd->range, kd->theta);
+		kd->eta = (1 - pow(2.0 / kd->range, 1 - kd->theta)) / (1 - zeta2 / kd->zetan);
+		kd->zeta2_bound = 1.0 + pow(0.5, kd->theta);
+	}
+	kd->hot_ops = cfg->hot_ops;
+	kd->hot_keys = (long)((double)cfg->range * cfg->hot_keys / 100.0);
+	if (kd->hot_keys < 1)
+		kd->hot_keys = 1;
+	kd->shift = 0;
+}
+
+/* Zipf-distributed rank in [1; range], rank 1 being the most popular */
+static inline long zipf_next(const key_dist_t *kd, bench_rng_t *rng)
+{
+	double u = rand_unit_re(rng);
+	double uz = u * kd->zetan;
+	long v;
+
+	if (uz < 1.0)
+		return 1;
+	if (uz < kd->zeta2_bound)
+		return 2;
+	v = 1 + (long)(kd->range * pow(kd->eta * u - kd->eta + 1, kd->alpha));
+	return (v > kd->range ? kd->range : v);
+}
+
+/* Random key, restricted to [B; B+b) in bias mode */
+static inline skey_t draw_key(thread_data_t *d)
+{
+	const key_dist_t *kd = d->dist;
+	long k;
+
+	if (d->bias_range > 0)
+		return d->bias_offset + rand_range_re(&d->rng, d->bias_range) - 1;
+
+	switch (kd->type) {
+	case DIST_ZIPF:
+		k = zipf_next(kd, &d->rng);
+		break;
+	case DIST_HOTSPOT:
+		if (rand_range_re(&d->rng, 100) <= kd->hot_ops)
+			k = rand_range_re(&d->rng, kd->hot_keys);
+		else if (kd->hot_keys == kd->range)
+			k = rand_range_re(&d->rng, kd->range);
+		else
+			k = kd->hot_keys + rand_range_re(&d->rng, kd->range - kd->hot_keys);
+		break;
+	default:
+		k = rand_range_re(&d->rng, d->range);
+	}
+	/* Phases move the hot keys around */
+	if (kd->shift > 0 && (k += kd->shift) > kd->range)
+		k -= kd->range;
+	return k;
+}
+
+/*
+ * Key of the next operation of type op. The sequential and latest
+ * distributions insert increasing keys: thread i of n takes initial+i+1,
+ * initial+n+i+1, ... (modulo the range) so that threads never contend on
+ * a shared counter, and the threads' insertion frontiers stay close as
+ * they run at similar rates. Other keys come from the pre-generated
+ * buffer if any (-K), as they do not depend on the frontier.
+ */
+static inline skey_t next_key(thread_data_t *d, int op)
+{
+	long k;
+
+	if (d->bias_range == 0 &&
+	    (d->dist->type == DIST_SEQUENTIAL || d->dist->type == DIST_LATEST)) {
+		if (op == OP_ADD || op == OP_MOVE) {
+			k = d->seq % d->dist->range + 1;
+			d->seq += d->seq_stride;
+			return k;
+		}
+		if (d->dist->type == DIST_LATEST) {
+			/* Most recently inserted keys are the most popular */
+			k = (long)(d->seq % d->dist->range) - zipf_next(d->dist, &d->rng);
+			return (k < 0 ? k + d->dist->range : k) + 1;
+		}
+	}
+	if (d->keys != NULL) {
+		k = d->keys[d->key_next];
+		if (++d->key_next == d->nb_keys)
+			d->key_next = 0;
+		return k;
+	}
+	return draw_key(d);
+}
+
+/* Draws the keys of the timed phase upfront, in the thread's own memory */
+static void keys_fill(thread_data_t *d)
+{
+	long i;
+
+	if ((d->keys = (skey_t *)malloc(d->nb_keys * sizeof(skey_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	for (i = 0; i < d->nb_keys; i++)
+		d->keys[i] = draw_key(d);
+	d->key_next = 0;
+}
+
+static inline int hist_index(uint64_t v)
+{
+	int shift;
+
+	if (v < HIST_SUB)
+		return (int)v;
+	shift = 63 - __builtin_clzll(v) - HIST_SUB_BITS;
+	return ((shift + 1) << HIST_SUB_BITS) + (int)((v >> shift) & (HIST_SUB - 1));
+}
+
+/* Highest value recorded in bucket idx */
+static uint64_t hist_value(int idx)
+{
+	int shift;
+
+	if (idx < HIST_SUB)
+		return (uint64_t)idx;
+	shift = (idx >> HIST_SUB_BITS) - 1;
+	return ((uint64_t)(HIST_SUB + (idx & (HIST_SUB - 1))) << shift) +
+		((uint64_t)1 << shift) - 1;
+}
+
+static inline void hist_record(bench_hist_t *h, uint64_t v)
+{
+	h->buckets[hist_index(v)]++;
+	if (h->count++ == 0 || v < h->min)
+		h->min = v;
+	if (v > h->max)
+		h->max = v;
+}
+
+static void hist_merge(bench_hist_t *to, const bench_hist_t *from)
+{
+	int i;
+
+	if (from->count == 0)
+		return;
+	if (to->count == 0 || from->min < to->min)
+		to->min = from->min;
+	if (from->max > to->max)
+		to->max = from->max;
+	to->count += from->count;
+	for (i = 0; i < HIST_BUCKETS; i++)
+		to->buckets[i] += from->buckets[i];
+}
+
+/* Value below which p percent of the recorded values fall */
+static uint64_t hist_percentile(const bench_hist_t *h, double p)
+{
+	unsigned long target, seen = 0;
+	uint64_t v;
+	int i;
+
+	target = (unsigned long)(p / 100.0 * h->count + 0.5);
+	if (target == 0)
+		target = 1;
+	for (i = 0; i < HIST_BUCKETS - 1; i++) {
+		seen += h->buckets[i];
+		if (seen >= target)
+			break;
+	}
+	v = hist_value(i);
+	return (v > h->max ? h->max : v);
+}
+
+/* Values recorded in cur but not yet in prev, cur being a later copy */
+static void hist_diff(bench_hist_t *to, const bench_hist_t *cur, const bench_hist_t *prev)
+{
+	int i;
+
+	to->count = 0;
+	to->min = 0;
+	to->max = 0;
+	for (i = 0; i < HIST_BUCKETS; i++) {
+		to->buckets[i] = cur->buckets[i] - prev->buckets[i];
+		if (to->buckets[i] != 0) {
+			to->count += to->buckets[i];
+			to->max = hist_value(i);
+		}
+	}
+}
+
+static inline uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+ * Returns the start time if this operation is sampled, 0 otherwise. In
+ * open loop, that is when the operation was due rather than when it was
+ * issued, so that the time spent queued behind a slow one is counted.
+ */
+static inline uint64_t lat_start(thread_data_t *d)
+{
+	if (d->lat == NULL || --d->lat_countdown > 0)
+		return 0;
+	d->lat_countdown = d->latency;
+	return (d->intended != 0 ? d->intended : now_ns());
+}
+
+static inline void lat_stop(thread_data_t *d, int op, int ok, uint64_t t0)
+{
+	if (t0 != 0)
+		hist_record(&d->lat[2 * op + (ok != 0)], now_ns() - t0);
+}
+
+/* Time between two arrivals of the thread's schedule (-Q, -J) */
+static inline uint64_t pace_gap(thread_data_t *d)
+{
+	if (d->arrivals == ARRIVAL_POISSON)
+		return (uint64_t)(-log(1.0 - rand_unit_re(&d->rng)) * d->gap_ns);
+	return (uint64_t)d->gap_ns;
+}
+
+/*
+ * Waits until the next operation of the schedule is due, if it is not
+ * already late. Returns 0 if the run stopped in the meantime.
+ */
+static int pace(thread_data_t *d)
+{
+	struct timespec ts;
+	uint64_t t, wait;
+
+	d->intended = d->next_ns;
+	d->next_ns += pace_gap(d);
+	while ((t = now_ns()) < d->intended) {
+		if (AO_load_full(&stop) != 0)
+			return 0;
+		if ((wait = d->intended - t) > PACE_SPIN_NS) {
+			/* Wake up early and check for the end of the run every ms */
+			wait -= PACE_SPIN_NS;
+			ts.tv_sec = 0;
+			ts.tv_nsec = (long)(wait < 1000000 ? wait : 1000000);
+			nanosleep(&ts, NULL);
+		}
+	}
+	return 1;
+}
+
+/*
+ * Deschedules the calling worker every bench_preempt_every calls, from a
+ * random start so that the threads do not all go at once. Maintenance
+ * and populating threads are left alone.
+ */
+void bench_preempt_slow(void)
+{
+	thread_data_t *d = preempt_self;
+
+	if (d == NULL || --d->preempt_countdown > 0)
+		return;
+	d->preempt_countdown = bench_preempt_every;
+	d->nb_preempted++;
+	if (preempt_us > 0)
+		usleep(preempt_us);
+	else
+		sched_yield();
+}
+
+/* CPUs the process may run on */
+static int online_cpus(void)
+{
+	cpu_set_t set;
+
+	if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+		perror("sched_getaffinity");
+		exit(1);
+	}
+	return CPU_COUNT(&set);
+}
+
+static int read_int(const char *fmt, int cpu, int dflt)
+{
+	char path[128];
+	FILE *f;
+	int v;
+
+	snprintf(path, sizeof(path), fmt, cpu);
+	if ((f = fopen(path, "r")) == NULL)
+		return dflt;
+	if (fscanf(f, "%d", &v) != 1)
+		v = dflt;
+	fclose(f);
+	return v;
+}
+
+static int pin_policy;
+
+/*
+ * compact fills a socket one core at a time before using the SMT
+ * siblings, then moves to the next socket; scatter goes round-robin over
+ * the sockets and the cores within them; smt fills whole cores, siblings
+ * first, so that thread pairs share a core.
+ */
+static int topo_cmp(const void *a, const void *b)
+{
+	const cpu_topo_t *x = (const cpu_topo_t *)a, *y = (const cpu_topo_t *)b;
+	int k1[3], k2[3], i;
+
+	switch (pin_policy) {
+	case PIN_COMPACT:
+		k1[0] = x->pkg; k1[1] = x->smt; k1[2] = x->core;
+		k2[0] = y->pkg; k2[1] = y->smt; k2[2] = y->core;
+		break;
+	case PIN_SCATTER:
+		k1[0] = x->smt; k1[1] = x->core; k1[2] = x->pkg;
+		k2[0] = y->smt; k2[1] = y->core; k2[2] = y->pkg;
+		break;
+	default:
+		k1[0] = x->pkg; k1[1] = x->core; k1[2] = x->smt;
+		k2[0] = y->pkg; k2[1] = y->core; k2[2] = y->smt;
+		break;
+	}
+	for (i = 0; i < 3; i++)
+		if (k1[i] != k2[i])
+			return k1[i] - k2[i];
+	return x->cpu - y->cpu;
+}
+
+/*
+ * Orders the CPUs the process may run on as per the policy, from the
+ * /sys topology; CPUs without topology information count as one core
+ * each on socket 0. Returns the number of CPUs.
+ */
+static int topo_order(int policy, int *cpus)
+{
+	cpu_topo_t *t;
+	cpu_set_t set;
+	int *rank, i, j, n = 0;
+
+	if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+		perror("sched_getaffinity");
+		exit(1);
+	}
+	if ((t = (cpu_topo_t *)calloc(CPU_SETSIZE, sizeof(cpu_topo_t))) == NULL ||
+	    (rank = (int *)calloc(CPU_SETSIZE, sizeof(int))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	for (i = 0; i < CPU_SETSIZE; i++) {
+		if (!CPU_ISSET(i, &set))
+			continue;
+		t[n].cpu = i;
+		t[n].pkg = read_int("/sys/devices/system/cpu/cpu%d/topology/physical_package_id", i, 0);
+		/* Physical core ids for now, turned into ranks below */
+		t[n].core = read_int("/sys/devices/system/cpu/cpu%d/topology/core_id", i, i);
+		n++;
+	}
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < i; j++)
+			if (t[j].pkg == t[i].pkg && t[j].core == t[i].core)
+				t[i].smt++;
+	}
+	/* Number of distinct cores of the socket with a lower id */
+	for (i = 0; i < n; i++)
+		for (j = 0; j < n; j++)
+			if (t[j].pkg == t[i].pkg && t[j].smt == 0 && t[j].core < t[i].core)
+				rank[i]++;
+	for (i = 0; i < n; i++)
+		t[i].core = rank[i];
+	pin_policy = policy;
+	qsort(t, n, sizeof(cpu_topo_t), topo_cmp);
+	for (i = 0; i < n; i++)
+		cpus[i] = t[i].cpu;
+	free(rank);
+	free(t);
+	return n;
+}
+
+/*
+ * Parses a CPU list such as 0-3,8,10 into cpus, exits unless all of them
+ * are available to the process. Returns the number of CPUs.
+ */
+static int parse_cpus(const char *arg, int *cpus)
+{
+	const char *list = arg;
+	cpu_set_t set;
+	int n = 0, lo, hi;
+	char *end;
+
+	if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+		perror("sched_getaffinity");
+		exit(1);
+	}
+
+	while (*arg != '\0') {
+		if (!isdigit((unsigned char)*arg))
+			goto invalid;
+		lo = hi = (int)strtol(arg, &end, 10);
+		if (*end == '-') {
+			if (!isdigit((unsigned char)end[1]))
+				goto invalid;
+			hi = (int)strtol(end + 1, &end, 10);
+		}
+		if (lo > hi || hi >= CPU_SETSIZE)
+			goto invalid;
+		for (; lo <= hi && n < CPU_SETSIZE; lo++) {
+			if (!CPU_ISSET(lo, &set)) {
+				printf("ERROR: CPU %d is not available\n", lo);
+				exit(1);
+			}
+			cpus[n++] = lo;
+		}
+		if (*end == ',')
+			end++;
+		else if (*end != '\0')
+			goto invalid;
+		arg = end;
+	}
+	if (n > 0)
+		return n;
+ invalid:
+	printf("ERROR: Invalid CPU list %s\n", list);
+	exit(1);
+}
+
+/*
+ * Sets the worker and background CPUs from -P and -G. Unless given
+ * explicitly, background threads take the CPUs that come after the
+ * workers in the policy order, so that they do not steal their cycles.
+ */
+static void pin_init(const bench_config_t *cfg)
+{
+	int *order, n;
+
+	if (cfg->pin == PIN_NONE && cfg->pin_bg == NULL)
+		return;
+	if ((order = (int *)malloc(CPU_SETSIZE * sizeof(int))) == NULL ||
+	    (pin_bg_cpus = (int *)malloc(CPU_SETSIZE * sizeof(int))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	if (cfg->pin == PIN_LIST)
+		n = parse_cpus(cfg->pin_cpus, order);
+	else
+		n = topo_order(cfg->pin == PIN_NONE ? PIN_SMT : cfg->pin, order);
+	if (cfg->pin != PIN_NONE) {
+		pin_cpus = order;
+		pin_ncpus = (n < cfg->nb_threads ? n : cfg->nb_threads);
+	}
+	if (cfg->pin_bg != NULL) {
+		pin_bg_ncpus = parse_cpus(cfg->pin_bg, pin_bg_cpus);
+	} else if (n > pin_ncpus) {
+		pin_bg_ncpus = n - pin_ncpus;
+		memcpy(pin_bg_cpus, order + pin_ncpus, pin_bg_ncpus * sizeof(int));
+	} else {
+		/* As many workers as CPUs: let the scheduler place them */
+		pin_bg_ncpus = 0;
+	}
+	if (pin_cpus == NULL)
+		free(order);
+}
+
+static void pin_self(int cpu)
+{
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+		fprintf(stderr, "Error pinning thread to CPU %d\n", cpu);
+		exit(1);
+	}
+}
+
+void bench_pin_background(void)
+{
+	if (pin_bg_ncpus > 0)
+		pin_self(pin_bg_cpus[AO_fetch_and_add1_full(&pin_bg_next) % pin_bg_ncpus]);
+}
+
+static void print_pinning(const bench_config_t *cfg)
+{
+	int i;
+
+	if (pin_ncpus > 0) {
+		printf("Pinning      : %s\n", cfg->pin == PIN_LIST ? "list" : pin_names[cfg->pin]);
+		printf("Worker CPUs  :");
+		for (i = 0; i < cfg->nb_threads; i++)
+			printf(" %d", pin_cpus[i % pin_ncpus]);
+		printf("\n");
+	}
+	if (pin_bg_ncpus > 0) {
+		printf("Backgr. CPUs :");
+		for (i = 0; i < pin_bg_ncpus; i++)
+			printf(" %d", pin_bg_cpus[i]);
+		printf("\n");
+	}
+}
+
+/* Parses the -P policy, anything else is taken as a CPU list */
+static void parse_pin(bench_config_t *cfg, const char *arg)
+{
+	int i;
+
+	for (i = 0; i < (int)(sizeof(pin_names) / sizeof(pin_names[0])); i++) {
+		if (strcmp(arg, pin_names[i]) == 0) {
+			cfg->pin = i;
+			return;
+		}
+	}
+	cfg->pin = PIN_LIST;
+	cfg->pin_cpus = arg;
+}
+
+#ifdef __linux__
+static int perf_open(int event, int user_only)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.disabled = 1;
+	attr.exclude_hv = 1;
+	attr.exclude_kernel = user_only;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	switch (event) {
+	case PERF_CYCLES:
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_CPU_CYCLES;
+		break;
+	case PERF_INSTRUCTIONS:
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+		break;
+	case PERF_L1D_MISSES:
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_L1D |
+			(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+			(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		break;
+	case PERF_LLC_MISSES:
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_CACHE_MISSES;
+		break;
+	case PERF_BRANCH_MISSES:
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+		break;
+	default:
+		attr.type = PERF_TYPE_SOFTWARE;
+		attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+		break;
+	}
+	/* Calling thread, any CPU */
+	return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+/*
+ * Opens the counters of the calling thread, disabled until perf_start().
+ * Kernel-side counting is dropped if perf_event_paranoid forbids it, and
+ * events the kernel or the hardware do not support are reported n/a.
+ */
+static void perf_init(bench_perf_t *p)
+{
+	int i;
+
+	for (i = 0; i < NB_PERF; i++) {
+		p->count[i] = PERF_NA;
+#ifdef __linux__
+		if ((p->fd[i] = perf_open(i, 0)) < 0)
+			p->fd[i] = perf_open(i, 1);
+#else
+		p->fd[i] = -1;
+#endif
+	}
+}
+
+static void perf_start(bench_perf_t *p)
+{
+#ifdef __linux__
+	int i;
+
+	for (i = 0; i < NB_PERF; i++)
+		if (p->fd[i] >= 0)
+			ioctl(p->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+/* Stops counting, counts are scaled up if the events were multiplexed */
+static void perf_stop(bench_perf_t *p)
+{
+#ifdef __linux__
+	uint64_t v[3];
+	int i;
+
+	for (i = 0; i < NB_PERF; i++)
+		if (p->fd[i] >= 0)
+			ioctl(p->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+	for (i = 0; i < NB_PERF; i++) {
+		if (p->fd[i] < 0)
+			continue;
+		if (read(p->fd[i], v, sizeof(v)) == (ssize_t)sizeof(v))
+			p->count[i] = (v[2] == 0 ? 0 :
+				       (uint64_t)((double)v[0] * v[1] / v[2]));
+		close(p->fd[i]);
+		p->fd[i] = -1;
+	}
+#endif
+}
+
+static void trace_grow(thread_data_t *d)
+{
+	d->trace_cap *= 2;
+	if ((d->trace = (uint64_t *)realloc(d->trace, d->trace_cap * sizeof(uint64_t))) == NULL) {
+		perror("realloc");
+		exit(1);
+	}
+}
+
+/* Appends an operation to the thread's trace if recording (-W) */
+static inline void trace_rec(thread_data_t *d, int op, skey_t key, int ok)
+{
+	if (d->trace == NULL)
+		return;
+	if (d->trace_len == d->trace_cap)
+		trace_grow(d);
+	d->trace[d->trace_len++] = ((uint64_t)op << TRACE_OP_SHIFT) |
+		(ok ? TRACE_OK : 0) | ((uint64_t)key & TRACE_KEY_MASK);
+}
+
+/*
+ * Linearizability checking (-C). Each thread logs when it invoked each
+ * add, remove and contains and when it got the response, a successful
+ * move being logged as a remove and an add. A set is one bit per key and
+ * a history is linearizable if and only if the subhistory of every key
+ * is, so the keys are checked apart, in parallel, after the run. Failed
+ * moves and snapshots depend on several keys and are not logged, a
+ * collected range query is logged as a contains of each key it spans and
+ * an overwrite as a contains of its key, as it leaves the set unchanged.
+ */
+typedef struct bench_event {
+	uint64_t call;
+	uint64_t ret;
+	skey_t key;
+	int thread;
+	unsigned char op;	/* OP_ADD, OP_REMOVE or OP_CONTAINS */
+	unsigned char ok;
+} bench_event_t;
+
+static void check_grow(thread_data_t *d)
+{
+	d->history_cap *= 2;
+	if ((d->history = (bench_event_t *)realloc(d->history, d->history_cap * sizeof(bench_event_t))) == NULL) {
+		perror("realloc");
+		exit(1);
+	}
+}
+
+/* Returns when an operation is invoked if checking (-C), 0 otherwise */
+static inline uint64_t check_start(thread_data_t *d)
+{
+	return (d->history != NULL ? now_ns() : 0);
+}
+
+/* Logs an operation invoked at call, which just responded */
+static inline void check_rec(thread_data_t *d, int op, skey_t key, int ok, uint64_t call)
+{
+	bench_event_t *e;
+
+	if (d->history == NULL)
+		return;
+	if (d->history_len == d->history_cap)
+		check_grow(d);
+	e = &d->history[d->history_len++];
+	e->ret = now_ns();
+	e->call = call;
+	e->key = key;
+	e->thread = d->id;
+	e->op = (unsigned char)op;
+	e->ok = (ok != 0);
+}
+
+static inline void check_move(thread_data_t *d, skey_t from, skey_t to, int ok, uint64_t call)
+{
+	if (ok && from != to) {
+		check_rec(d, OP_REMOVE, from, 1, call);
+		check_rec(d, OP_ADD, to, 1, call);
+	}
+}
+
+/*
+ * Logs each key of [lo, hi] as found if among the n keys the range query
+ * returned. This checks every key on its own, so a weakly consistent scan
+ * passes as well: that the scan saw the keys at a single point in time is
+ * not checked.
+ */
+static void check_range(thread_data_t *d, skey_t lo, skey_t hi, long n, uint64_t call)
+{
+	skey_t k;
+	long i = 0;
+
+	if (d->history == NULL || d->range_keys == NULL)
+		return;
+	for (k = lo; k <= hi; k++) {
+		if (i < n && d->range_keys[i] == k) {
+			check_rec(d, OP_CONTAINS, k, 1, call);
+			i++;
+		} else {
+			check_rec(d, OP_CONTAINS, k, 0, call);
+		}
+	}
+}
+
+/*
+ * Map mode (-V): every word of a value holds its key in the low 32 bits
+ * and a version in the high ones, so that get can tell a torn or
+ * misplaced value from one that was put.
+ */
+static inline void value_fill(thread_data_t *d, skey_t key)
+{
+	uint64_t w = ((uint64_t)++d->value_version << 32) | (uint32_t)key;
+	long i;
+
+	for (i = 0; i < d->value_words; i++)
+		d->value[i] = w;
+}
+
+static void value_alloc(thread_data_t *d)
+{
+	if (d->value_words > 0 &&
+	    (d->value = (uint64_t *)malloc(d->value_words * sizeof(uint64_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+}
+
+/* Adds key to the set, mapped to a fresh value in map mode */
+static inline int set_add(thread_data_t *d, skey_t key)
+{
+	if (d->value == NULL)
+		return d->ops->add(d->set, key, d);
+	value_fill(d, key);
+	return d->ops->put(d->set, key, d->value, d);
+}
+
+/* Looks key up, getting and checking its value in map mode */
+static inline int set_contains(thread_data_t *d, skey_t key)
+{
+	int res;
+
+	if (d->value == NULL)
+		return d->ops->contains(d->set, key, d);
+	res = d->ops->get(d->set, key, d->value, d);
+	if (res && ((uint32_t)d->value[0] != (uint32_t)key ||
+		    d->value[d->value_words - 1] != d->value[0]))
+		d->nb_value_errors++;
+	return res;
+}
+
+static inline int set_overwrite(thread_data_t *d, skey_t key)
+{
+	value_fill(d, key);
+	return d->ops->overwrite(d->set, key, d->value, d);
+}
+
+/* Writes the threads' traces, one stream per thread */
+static void trace_write(const char *file, const thread_data_t *data,
+			const bench_config_t *cfg)
+{
+	trace_header_t h;
+	trace_stream_t st;
+	uint64_t offset;
+	FILE *f;
+	int i;
+
+	if ((f = fopen(file, "wb")) == NULL) {
+		perror(file);
+		exit(1);
+	}
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+	h.version = TRACE_VERSION;
+	h.flags = 0;
+	h.nb_streams = cfg->nb_threads;
+	h.range = cfg->range;
+	fwrite(&h, sizeof(h), 1, f);
+	offset = sizeof(h) + cfg->nb_threads * sizeof(trace_stream_t);
+	for (i = 0; i < cfg->nb_threads; i++) {
+		st.offset = offset;
+		st.nb_records = data[i].trace_len;
+		fwrite(&st, sizeof(st), 1, f);
+		offset += data[i].trace_len * sizeof(uint64_t);
+	}
+	for (i = 0; i < cfg->nb_threads; i++)
+		fwrite(data[i].trace, sizeof(uint64_t), data[i].trace_len, f);
+	if (fclose(f) != 0) {
+		perror(file);
+		exit(1);
+	}
+}
+
+/*
+ * Maps a trace and checks it against the structure. The check reads all
+ * the records, so the pages are in memory before the timed phase.
+ * Returns the stream table.
+ */
+static const trace_stream_t *trace_open(const char *file, const bench_ops_t *ops,
+					const bench_config_t *cfg)
+{
+	const trace_header_t *h;
+	const trace_stream_t *st;
+	const uint64_t *w;
+	struct stat sb;
+	uint64_t i, j;
+	int fd, op;
+
+	if ((fd = open(file, O_RDONLY)) < 0 || fstat(fd, &sb) != 0) {
+		perror(file);
+		exit(1);
+	}
+	trace_size = sb.st_size;
+	if (trace_size < sizeof(trace_header_t) ||
+	    (trace_map = mmap(NULL, trace_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+		printf("ERROR: Cannot map trace %s\n", file);
+		exit(1);
+	}
+	close(fd);
+	h = (const trace_header_t *)trace_map;
+	if (memcmp(h->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 ||
+	    h->version != TRACE_VERSION || h->flags != 0 || h->nb_streams == 0 ||
+	    h->nb_streams > (trace_size - sizeof(*h)) / sizeof(trace_stream_t)) {
+		printf("ERROR: %s is not a version " XSTR(TRACE_VERSION) " trace\n", file);
+		exit(1);
+	}
+	st = (const trace_stream_t *)(h + 1);
+	for (i = 0; i < h->nb_streams; i++) {
+		if (st[i].offset % sizeof(uint64_t) != 0 || st[i].offset > trace_size ||
+		    st[i].nb_records > (trace_size - st[i].offset) / sizeof(uint64_t)) {
+			printf("ERROR: Stream %lu of %s is truncated\n", (unsigned long)i, file);
+			exit(1);
+		}
+		w = (const uint64_t *)((const char *)trace_map + st[i].offset);
+		for (j = 0; j < st[i].nb_records; j++) {
+			op = trace_op(w[j]);
+			if (op >= NB_OPS ||
+			    ((op == OP_MOVE || op == OP_RANGE) &&
+			     (j + 1 == st[i].nb_records || trace_op(w[j + 1]) != op)) ||
+			    (op == OP_MOVE && ops->move == NULL) ||
+			    (op == OP_SNAPSHOT && ops->snapshot == NULL) ||
+			    (op == OP_RANGE && ops->range == NULL) ||
+			    (op == OP_OVERWRITE && cfg->value_size == 0)) {
+				printf("ERROR: Record %lu of stream %lu of %s cannot be replayed\n",
+				       (unsigned long)j, (unsigned long)i, file);
+				exit(1);
+			}
+			/* Skip the added key of a move, the highest key of a range */
+			j += (op == OP_MOVE || op == OP_RANGE);
+		}
+	}
+	return st;
+}
+
+/* Range query over [lo, hi], returns whether it found any key */
+static int range_run(thread_data_t *d, skey_t lo, skey_t hi)
+{
+	uint64_t t0, c0;
+	long n;
+
+	if (d->range_keys != NULL && hi - lo + 1 > d->range_cap) {
+		d->range_cap = hi - lo + 1;
+		free(d->range_keys);
+		if ((d->range_keys = (skey_t *)malloc(d->range_cap * sizeof(skey_t))) == NULL) {
+			perror("malloc");
+			exit(1);
+		}
+	}
+	c0 = check_start(d);
+	t0 = lat_start(d);
+	n = d->ops->range(d->set, lo, hi, d->range_keys, d);
+	lat_stop(d, OP_RANGE, n > 0, t0);
+	check_range(d, lo, hi, n, c0);
+	if (n > 0)
+		d->nb_ranged++;
+	d->nb_range++;
+	d->nb_range_keys += n;
+	return (n > 0);
+}
+
+/* Applies the thread's stream (-R) until its end or the end of the run */
+static void replay_run(thread_data_t *d)
+{
+	const bench_ops_t *ops = d->ops;
+	const uint64_t *w = d->replay, *end = d->replay + d->replay_len;
+	skey_t key, to = 0;
+	uint64_t t0, c0;
+	int op, res;
+
+	for (; w < end && AO_load_full(&stop) == 0; w++) {
+		if (d->gap_ns > 0 && !pace(d))
+			break;
+		op = trace_op(*w);
+		key = (skey_t)(*w & TRACE_KEY_MASK);
+		if (op == OP_RANGE) {
+			w++;
+			range_run(d, key, (skey_t)(*w & TRACE_KEY_MASK));
+			continue;
+		}
+		c0 = check_start(d);
+		t0 = lat_start(d);
+		switch (op) {
+		case OP_ADD:
+			if ((res = set_add(d, key)))
+				d->nb_added++;
+			d->nb_add++;
+			break;
+		case OP_REMOVE:
+			if ((res = ops->remove(d->set, key, d)))
+				d->nb_removed++;
+			d->nb_remove++;
+			break;
+		case OP_CONTAINS:
+			if ((res = set_contains(d, key)))
+				d->nb_found++;
+			d->nb_contains++;
+			break;
+		case OP_OVERWRITE:
+			if ((res = set_overwrite(d, key)))
+				d->nb_overwritten++;
+			d->nb_overwrite++;
+			break;
+		case OP_MOVE:
+			w++;
+			to = (skey_t)(*w & TRACE_KEY_MASK);
+			if ((res = ops->move(d->set, key, to, d)))
+				d->nb_moved++;
+			d->nb_move++;
+			break;
+		default:
+			if ((res = ops->snapshot(d->set, d)))
+				d->nb_snapshoted++;
+			d->nb_snapshot++;
+			break;
+		}
+		lat_stop(d, op, res, t0);
+		if (op == OP_MOVE)
+			check_move(d, key, to, res, c0);
+		else if (op == OP_OVERWRITE)
+			check_rec(d, OP_CONTAINS, key, res, c0);
+		else if (op != OP_SNAPSHOT)
+			check_rec(d, op, key, res, c0);
+	}
+}
+
+/*
+ * Moves the thread to the phase the main thread started, parked until a
+ * later one if that phase runs fewer threads. Effective updates count
+ * from the start of the phase, so that its update rate holds from its
+ * first operations whatever the previous phases ran.
+ */
+static void phase_enter(thread_data_t *d)
+{
+	const phase_t *p;
+	struct timespec ts = { 0, PHASE_PARK_NS };
+	int parked = 0;
+
+	for (;;) {
+		d->phase = AO_load_full(&phase_cur);
+		p = &phases[d->phase];
+		if (d->id < p->nb_threads || AO_load_full(&stop))
+			break;
+		while (AO_load_full(&phase_cur) == d->phase && AO_load_full(&stop) == 0)
+			nanosleep(&ts, NULL);
+		parked = 1;
+	}
+	d->update = p->update;
+	d->dist = &p->dist;
+	d->phase_tx = d->nb_contains + d->nb_add + d->nb_remove + d->nb_move +
+		d->nb_snapshot + d->nb_range + d->nb_overwrite;
+	d->phase_upd = d->nb_added + d->nb_removed + d->nb_moved + d->nb_overwritten;
+	/* In open loop, a parked thread does not owe the ops it missed */
+	if (parked && d->gap_ns > 0)
+		d->next_ns = now_ns();
+}
+
+static void *test(void *data)
+{
+	int r, res, unext, mnext, onext, cnext, qnext;
+	unsigned long numtx, n = 0;
+	uint64_t t0, c0;
+	skey_t val = 0, val2, last = -1;
+	thread_data_t *d = (thread_data_t *)data;
+	const bench_ops_t *ops = d->ops;
+
+	/* Before thread_enter so that per-thread state is allocated locally */
+	if (pin_ncpus > 0)
+		pin_self(pin_cpus[d->id % pin_ncpus]);
+	if (ops->thread_enter != NULL)
+		ops->thread_enter(d->set, d);
+	if (d->nb_keys > 0)
+		keys_fill(d);
+	if (d->range_cap > 0 &&
+	    (d->range_keys = (skey_t *)malloc(d->range_cap * sizeof(skey_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	value_alloc(d);
+	if (bench_preempt_every > 0)
+		preempt_self = d;
+	if (d->perf != NULL)
+		perf_init(d->perf);
+	/* Wait on barrier */
+	barrier_cross(d->barrier);
+	if (d->perf != NULL)
+		perf_start(d->perf);
+	d->start_ns = now_ns();
+	if (d->gap_ns > 0) {
+#ifdef __linux__
+		/* The default 50us timer slack would delay every paced op */
+		prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+#endif
+		/* Threads on a constant schedule start out of phase */
+		d->next_ns = d->start_ns;
+		if (d->arrivals == ARRIVAL_CONSTANT)
+			d->next_ns += (uint64_t)(rand_unit_re(&d->rng) * d->gap_ns);
+	}
+
+	if (d->replay != NULL) {
+		replay_run(d);
+		goto done;
+	}
+	if (nb_phases > 0)
+		phase_enter(d);
+
+	/* Is the first op an update, a move, an overwrite, a range, a contains? */
+	r = rand_range_re(&d->rng, 100) - 1;
+	unext = (r < d->update);
+	mnext = (r < d->move);
+	onext = (r >= d->move && r < d->move + d->overwrite);
+	cnext = (r >= d->update + d->snapshot);
+	qnext = (cnext && r < d->update + d->snapshot + d->range_rate);
+
+	while (AO_load_full(&stop) == 0 && (d->op_count == 0 || n++ < d->op_count)) {
+
+		if (nb_phases > 0 && d->phase != AO_load_full(&phase_cur))
+			phase_enter(d);
+
+		/* In open loop, wait for the next arrival */
+		if (d->gap_ns > 0 && !pace(d))
+			break;
+
+		/* In bias mode, flip between add and remove at random */
+		if (d->bias_range > 0)
+			last = (rand_range_re(&d->rng, 2) == 1) ? -1 : next_key(d, OP_REMOVE);
+
+		if (unext) { // update
+
+			if (mnext) { // move
+
+				if (last < 0) val = next_key(d, OP_REMOVE);
+				else val = last;
+				val2 = next_key(d, OP_MOVE);
+				c0 = check_start(d);
+				t0 = lat_start(d);
+				res = ops->move(d->set, val, val2, d);
+				lat_stop(d, OP_MOVE, res, t0);
+				check_move(d, val, val2, res, c0);
+				trace_rec(d, OP_MOVE, val, res);
+				trace_rec(d, OP_MOVE, val2, res);
+				if (res) {
+					d->nb_moved++;
+					last = -1;
+				}
+				d->nb_move++;
+
+			} else if (onext) { // overwrite
+
+				val = next_key(d, OP_CONTAINS);
+				c0 = check_start(d);
+				t0 = lat_start(d);
+				res = set_overwrite(d, val);
+				lat_stop(d, OP_OVERWRITE, res, t0);
+				check_rec(d, OP_CONTAINS, val, res, c0);
+				trace_rec(d, OP_OVERWRITE, val, res);
+				if (res)
+					d->nb_overwritten++;
+				d->nb_overwrite++;
+
+			} else if (last < 0 ||
+				   (d->growth > 0 && rand_range_re(&d->rng, 100) <= d->growth)) { // add
+
+				val = next_key(d, OP_ADD);
+				c0 = check_start(d);
+				t0 = lat_start(d);
+				res = set_add(d, val);
+				lat_stop(d, OP_ADD, res, t0);
+				check_rec(d, OP_ADD, val, res, c0);
+				trace_rec(d, OP_ADD, val, res);
+				if (res) {
+					d->nb_added++;
+					last = val;
+				}
+				d->nb_add++;
+
+			} else { // remove
+
+				if (d->alternate) { // alternate mode
+					c0 = check_start(d);
+					t0 = lat_start(d);
+					res = ops->remove(d->set, last, d);
+					lat_stop(d, OP_REMOVE, res, t0);
+					check_rec(d, OP_REMOVE, last, res, c0);
+					trace_rec(d, OP_REMOVE, last, res);
+					if (res) {
+						d->nb_removed++;
+					}
+					last = -1;
+				} else {
+					/* Random computation only in non-alternated cases */
+					val = next_key(d, OP_REMOVE);
+					/* Remove one random value */
+					c0 = check_start(d);
+					t0 = lat_start(d);
+					res = ops->remove(d->set, val, d);
+					lat_stop(d, OP_REMOVE, res, t0);
+					check_rec(d, OP_REMOVE, val, res, c0);
+					trace_rec(d, OP_REMOVE, val, res);
+					if (res) {
+						d->nb_removed++;
+						/* Repeat until successful, to avoid size variations */
+						last = -1;
+					}
+				}
+				d->nb_remove++;
+			}
+
+		} else { // read
+
+			if (qnext) { // range
+
+				val = next_key(d, OP_CONTAINS);
+				val2 = (d->range - val < d->range_len ? d->range : val + d->range_len - 1);
+				res = range_run(d, val, val2);
+				trace_rec(d, OP_RANGE, val, res);
+				trace_rec(d, OP_RANGE, val2, res);
+
+			} else if (cnext) { // contains (no snapshot)
+
+				if (d->alternate) {
+					if (d->update == 0) {
+						if (last < 0) {
+							val = d->first;
+							last = val;
+						} else { // last >= 0
+							val = next_key(d, OP_CONTAINS);
+							last = -1;
+						}
+					} else { // update != 0
+						if (last < 0) {
+							val = next_key(d, OP_CONTAINS);
+						} else {
+							val = last;
+						}
+					}
+				} else val = next_key(d, OP_CONTAINS);
+
+				c0 = check_start(d);
+				t0 = lat_start(d);
+				res = set_contains(d, val);
+				lat_stop(d, OP_CONTAINS, res, t0);
+				check_rec(d, OP_CONTAINS, val, res, c0);
+				trace_rec(d, OP_CONTAINS, val, res);
+				if (res)
+					d->nb_found++;
+				d->nb_contains++;
+
+			} else { // snapshot
+
+				t0 = lat_start(d);
+				res = ops->snapshot(d->set, d);
+				lat_stop(d, OP_SNAPSHOT, res, t0);
+				trace_rec(d, OP_SNAPSHOT, 0, res);
+				if (res)
+					d->nb_snapshoted++;
+				d->nb_snapshot++;
+
+			}
+		}
+
+		/* Is the next op an update, a move, an overwrite, a range, a contains? */
+		if (d->effective) { // a failed remove/add is a read-only tx
+			numtx = d->nb_contains + d->nb_add + d->nb_remove + d->nb_move +
+				d->nb_snapshot + d->nb_range + d->nb_overwrite;
+			unext = ((100 * (d->nb_added + d->nb_removed + d->nb_moved +
+					 d->nb_overwritten - d->phase_upd)) <
+				 (d->update * (numtx - d->phase_tx)));
+			mnext = ((100 * d->nb_moved) < (d->move * numtx));
+			onext = ((100 * d->nb_overwritten) < (d->overwrite * numtx));
+			cnext = !((100 * d->nb_snapshoted) < (d->snapshot * numtx));
+			qnext = ((100 * d->nb_range) < (d->range_rate * numtx));
+		} else { // remove/add (even failed) is considered as an update
+			r = rand_range_re(&d->rng, 100) - 1;
+			unext = (r < d->update);
+			mnext = (r < d->move);
+			onext = (r >= d->move && r < d->move + d->overwrite);
+			cnext = (r >= d->update + d->snapshot);
+			qnext = (cnext && r < d->update + d->snapshot + d->range_rate);
+		}
+	}
+ done:
+	t0 = now_ns();
+	d->elapsed_ns = t0 - d->start_ns;
+	if (d->gap_ns > 0 && t0 > d->next_ns)
+		d->behind_ns = t0 - d->next_ns;
+	if (d->perf != NULL)
+		perf_stop(d->perf);
+	AO_fetch_and_sub1_full(&nb_running);
+
+	if (ops->thread_exit != NULL)
+		ops->thread_exit(d->set, d);
+
+	return NULL;
+}
+
+static void thread_data_init(thread_data_t *d, int id, const bench_config_t *cfg,
+			     const bench_ops_t *ops, void *set, barrier_t *barrier)
+{
+	memset(d, 0, sizeof(thread_data_t));
+	d->id = id;
+	d->range = cfg->range;
+	d->update = cfg->update;
+	d->move = cfg->move;
+	d->snapshot = cfg->snapshot;
+	d->range_rate = cfg->range_rate;
+	d->range_len = cfg->range_len;
+	d->overwrite = cfg->overwrite;
+	/* Values are allocated by the thread, as range query buffers */
+	d->value_words = cfg->value_size / sizeof(uint64_t);
+	/* Collected range queries need a buffer, allocated by the thread */
+	if (ops->range != NULL && !cfg->range_count &&
+	    (cfg->range_rate > 0 || cfg->trace_in != NULL))
+		d->range_cap = cfg->range_len;
+	d->unit_tx = cfg->unit_tx;
+	d->alternate = cfg->alternate;
+	d->growth = cfg->growth;
+	d->effective = cfg->effective;
+	d->bias_range = cfg->bias_range;
+	d->bias_offset = cfg->bias_offset;
+	d->seq = cfg->initial + id;
+	d->seq_stride = cfg->nb_threads;
+	d->dist = &dist;
+	d->nb_keys = cfg->key_buffer;
+	d->op_count = cfg->op_count;
+	rand_init(&d->rng, (unsigned int)cfg->seed, (unsigned int)id + 1);
+	d->latency = cfg->latency;
+	if (cfg->preempt > 0)
+		d->preempt_countdown = rand_range_re(&d->rng, cfg->preempt);
+	if (cfg->rate > 0)
+		d->gap_ns = 1e9 / cfg->rate;
+	d->arrivals = cfg->arrivals;
+	d->set = set;
+	d->barrier = barrier;
+	d->ops = ops;
+}
+
+/* Histograms of the timed phase, the populating thread is not timed */
+static bench_hist_t *lat_alloc(thread_data_t *d)
+{
+	bench_hist_t *h;
+
+	if ((h = (bench_hist_t *)calloc(2 * NB_OPS, sizeof(bench_hist_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	/* Spread the timed operations of the different threads */
+	d->lat_countdown = rand_range_re(&d->rng, d->latency);
+	return h;
+}
+
+void *bench_bulk_alloc(size_t size)
+{
+	bulk_block_t *b = (bulk_nb_blocks > 0 ? &bulk_blocks[bulk_nb_blocks - 1] : NULL);
+	size_t len;
+	void *p;
+
+	size = (size + 15) & ~(size_t)15;
+	if (b == NULL || b->next + size > b->end) {
+		assert(bulk_nb_blocks < BULK_MAX_BLOCKS);
+		len = (size_t)BULK_BLOCK << bulk_nb_blocks;
+		if (len < size)
+			len = size;
+		b = &bulk_blocks[bulk_nb_blocks];
+		if (posix_memalign((void **)&b->base, 64, len) != 0) {
+			perror("malloc");
+			exit(1);
+		}
+		b->next = b->base;
+		b->end = b->base + len;
+		bulk_nb_blocks++;
+	}
+	p = b->next;
+	b->next += size;
+	return p;
+}
+
+int bench_bulk_owns(const void *p)
+{
+	int i;
+
+	for (i = 0; i < bulk_nb_blocks; i++)
+		if ((const char *)p >= bulk_blocks[i].base && (const char *)p < bulk_blocks[i].end)
+			return 1;
+	return 0;
+}
+
+static void bulk_free(void)
+{
+	int i;
+
+	for (i = 0; i < bulk_nb_blocks; i++)
+		free(bulk_blocks[i].base);
+	bulk_nb_blocks = 0;
+}
+
+/*
+ * Share of the initial population filled by one thread: count keys of
+ * [lo; hi], random unless -m/-v ask for all of them in order.
+ */
+typedef struct prefill {
+	thread_data_t d;
+	skey_t lo;
+	skey_t hi;
+	long count;
+	skey_t last;		/* last key added */
+	const bench_config_t *cfg;
+} prefill_t;
+
+static int skey_cmp(const void *a, const void *b)
+{
+	skey_t x = *(const skey_t *)a, y = *(const skey_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* Draws the share's keys upfront, distinct and in increasing order (-Y) */
+static skey_t *prefill_sorted(prefill_t *p)
+{
+	skey_t *keys, key;
+	long i, n = 0, size = p->hi - p->lo + 1;
+
+	if ((keys = (skey_t *)malloc((p->count + 1) * sizeof(skey_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	/* Dense slices: selection sampling (Knuth's algorithm S) in one pass */
+	if (p->count > size / 8) {
+		for (key = p->lo; n < p->count; key++)
+			if ((long)rand_below(&p->d.rng, size - (key - p->lo)) < p->count - n)
+				keys[n++] = key;
+		return keys;
+	}
+	/* Sparse ones: redraw the few duplicates */
+	while (n < p->count) {
+		for (i = n; i < p->count; i++)
+			keys[i] = p->lo - 1 + rand_range_re(&p->d.rng, p->hi - p->lo + 1);
+		qsort(keys, p->count, sizeof(skey_t), skey_cmp);
+		for (i = n = 1; i < p->count; i++)
+			if (keys[i] != keys[n - 1])
+				keys[n++] = keys[i];
+	}
+	return keys;
+}
+
+static void prefill_fill(prefill_t *p)
+{
+	thread_data_t *d = &p->d;
+	const bench_ops_t *ops = d->ops;
+	const bench_config_t *cfg = p->cfg;
+	skey_t *keys = NULL, val;
+	long i = 0;
+
+	if (ops->thread_enter != NULL)
+		ops->thread_enter(d->set, d);
+	value_alloc(d);
+	if (cfg->bulk) {
+		/* Increasing order whatever -m/-v say, as bulk_build wants */
+		if (cfg->mono_int || cfg->reverse_int) {
+			if ((keys = (skey_t *)malloc((p->count + 1) * sizeof(skey_t))) == NULL) {
+				perror("malloc");
+				exit(1);
+			}
+			for (i = 0; i < p->count; i++)
+				keys[i] = p->lo + i;
+		} else {
+			keys = prefill_sorted(p);
+		}
+		if (p->count > 0) {
+			ops->bulk_build(d->set, keys, p->count, d);
+			p->last = keys[p->count - 1];
+		}
+		i = p->count;
+	} else if (cfg->prefill_sorted && !cfg->mono_int && !cfg->reverse_int) {
+		keys = prefill_sorted(p);
+	}
+	while (i < p->count) {
+		if (cfg->mono_int)
+			val = p->lo + i;
+		else if (cfg->reverse_int)
+			val = p->hi - i;
+		else if (keys != NULL)
+			val = keys[i];
+		else
+			val = p->lo - 1 + rand_range_re(&d->rng, p->hi - p->lo + 1);
+		if (set_add(d, val))
+			p->last = val;
+		else if (keys == NULL && !cfg->mono_int && !cfg->reverse_int)
+			continue;	/* drawn twice, draw again */
+		i++;
+	}
+	free(keys);
+	free(d->value);
+	if (ops->thread_exit != NULL)
+		ops->thread_exit(d->set, d);
+}
+
+static void *prefill_run(void *arg)
+{
+	prefill_t *p = (prefill_t *)arg;
+
+	/* Where the worker of the same id runs, for first-touch placement */
+	if (pin_ncpus > 0)
+		pin_self(pin_cpus[p->d.id % pin_ncpus]);
+	prefill_fill(p);
+	return NULL;
+}
+
+/*
+ * Adds cfg->initial keys to the set, from the main thread or, with -F,
+ * from as many threads each filling its own slice of the key range; the
+ * slices get as many keys each, give or take one. Returns a key added.
+ */
+static skey_t populate(void *set, const bench_config_t *cfg, const bench_ops_t *ops)
+{
+	prefill_t *p;
+	pthread_t *threads;
+	long range;
+	skey_t lo = 1, last;
+	uint64_t t0;
+	int i, n = (cfg->prefill > 0 ? cfg->prefill : 1);
+
+	if (posix_memalign((void **)&p, 64, n * sizeof(prefill_t)) != 0 ||
+	    (threads = (pthread_t *)malloc(n * sizeof(pthread_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	range = (cfg->mono_int || cfg->reverse_int || cfg->unbalanced ?
+		 cfg->initial : cfg->range);
+	/* range >= initial, so each slice has room for its keys */
+	for (i = 0; i < n; i++) {
+		thread_data_init(&p[i].d, i, cfg, ops, set, NULL);
+		p[i].lo = lo;
+		p[i].hi = lo + range / n + (i < range % n) - 1;
+		p[i].count = cfg->initial / n + (i < cfg->initial % n);
+		p[i].last = 0;
+		p[i].cfg = cfg;
+		lo = p[i].hi + 1;
+	}
+
+	t0 = now_ns();
+	if (cfg->prefill == 0) {
+		/* The set is not accessed concurrently, as before -F */
+		p[0].d.unit_tx = 0;
+		rand_init(&p[0].d.rng, (unsigned int)cfg->seed, 0);
+		prefill_fill(&p[0]);
+	} else {
+		for (i = 0; i < n; i++) {
+			/* Streams of their own, after the workers' */
+			rand_init(&p[i].d.rng, (unsigned int)cfg->seed,
+				  (unsigned int)(cfg->nb_threads + 1 + i));
+			if (pthread_create(&threads[i], NULL, prefill_run, &p[i]) != 0) {
+				fprintf(stderr, "Error creating thread\n");
+				exit(1);
+			}
+		}
+		for (i = 0; i < n; i++) {
+			if (pthread_join(threads[i], NULL) != 0) {
+				fprintf(stderr, "Error waiting for thread completion\n");
+				exit(1);
+			}
+		}
+	}
+	prefill_ns = now_ns() - t0;
+
+	for (i = 0; i < n && p[i].last == 0; i++)
+		;
+	last = (i < n ? p[i].last : 0);
+	free(threads);
+	free(p);
+	return last;
+}
+
+static void print_latency(const thread_data_t *data, const bench_config_t *cfg)
+{
+	bench_hist_t *total;
+	const bench_hist_t *h;
+	int i, j;
+
+	if ((total = (bench_hist_t *)calloc(2 * NB_OPS, sizeof(bench_hist_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	for (i = 0; i < cfg->nb_threads; i++)
+		for (j = 0; j < 2 * NB_OPS; j++)
+			hist_merge(&total[j], &data[i].lat[j]);
+
+	printf("Latency (ns)  : 1 op in %d timed%s\n", cfg->latency,
+	       cfg->rate > 0 ? ", from its scheduled start" : "");
+	for (j = 0; j < 2 * NB_OPS; j++) {
+		h = &total[j];
+		if (h->count == 0)
+			continue;
+		printf("  %-9s %-4s: #%lu min %lu p50 %lu p90 %lu p99 %lu p99.9 %lu max %lu\n",
+		       op_names[j / 2], (j % 2 ? "ok" : "fail"), h->count,
+		       (unsigned long)h->min,
+		       (unsigned long)hist_percentile(h, 50.0),
+		       (unsigned long)hist_percentile(h, 90.0),
+		       (unsigned long)hist_percentile(h, 99.0),
+		       (unsigned long)hist_percentile(h, 99.9),
+		       (unsigned long)h->max);
+	}
+	free(total);
+}
+
+/* Outcome of the check of one key */
+enum { CHECK_OK, CHECK_FAILED, CHECK_FINAL, CHECK_UNKNOWN };
+
+typedef struct check_key {
+	long start;		/* events of the key in the sorted history */
+	long end;
+	long bad_start;		/* events with no linearization, if failed */
+	long bad_end;
+	int final;		/* 1 if the key is in the set after the run */
+	int result;
+} check_key_t;
+
+/* One frame per event taking effect on the current search path */
+typedef struct check_frame {
+	long i;			/* event taken, -1 when entering the frame */
+	uint64_t cutoff;	/* earliest response among those scanned */
+	uint64_t hash;		/* of the events taken */
+	int s;			/* state, 1 if the key is present */
+} check_frame_t;
+
+typedef struct check_search {
+	long *next;		/* events not taken, a circular list through n */
+	long *prev;
+	check_frame_t *stack;
+	long cap;
+	uint64_t *seen;		/* hashes of the visited nodes, 0 if free */
+	long seen_mask;
+	long seen_len;
+} check_search_t;
+
+typedef struct check_job {
+	const bench_event_t *ev;
+	check_key_t *keys;
+	long nb_keys;
+	volatile AO_t next;
+} check_job_t;
+
+static long check_failed, check_unknown;
+
+static int event_cmp(const void *a, const void *b)
+{
+	const bench_event_t *x = (const bench_event_t *)a, *y = (const bench_event_t *)b;
+
+	if (x->key != y->key)
+		return (x->key < y->key ? -1 : 1);
+	if (x->call != y->call)
+		return (x->call < y->call ? -1 : 1);
+	return (x->ret < y->ret ? -1 : x->ret > y->ret);
+}
+
+static inline uint64_t check_mix(uint64_t z)
+{
+	z += 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/* State after e takes effect in state s, -1 if e cannot take effect then */
+static inline int check_apply(const bench_event_t *e, int s)
+{
+	switch (e->op) {
+	case OP_ADD:
+		return (e->ok != s ? 1 : -1);
+	case OP_REMOVE:
+		return (e->ok == s ? 0 : -1);
+	default:
+		return (e->ok == s ? s : -1);
+	}
+}
+
+static void check_seen_reset(check_search_t *c, long size)
+{
+	if (c->seen == NULL || c->seen_mask + 1 != size) {
+		free(c->seen);
+		if ((c->seen = (uint64_t *)malloc(size * sizeof(uint64_t))) == NULL) {
+			perror("malloc");
+			exit(1);
+		}
+		c->seen_mask = size - 1;
+	}
+	memset(c->seen, 0, size * sizeof(uint64_t));
+	c->seen_len = 0;
+}
+
+/*
+ * Marks node h visited. Returns 0 if it already was, -1 if the table is
+ * at CHECK_MAX_STATES. Only the 64-bit hashes are kept, a collision would
+ * prune a node unexplored but is unlikely well beyond that many states.
+ */
+static int check_visit(check_search_t *c, uint64_t h)
+{
+	uint64_t *old;
+	long i, j, n;
+
+	if (h == 0)
+		h = 1;
+	if (2 * (c->seen_len + 1) > c->seen_mask + 1) {
+		if (c->seen_len >= CHECK_MAX_STATES)
+			return -1;
+		old = c->seen;
+		n = c->seen_mask + 1;
+		c->seen = NULL;
+		check_seen_reset(c, 2 * n);
+		for (i = 0; i < n; i++) {
+			if (old[i] == 0)
+				continue;
+			for (j = old[i] & c->seen_mask; c->seen[j] != 0; j = (j + 1) & c->seen_mask)
+				;
+			c->seen[j] = old[i];
+			c->seen_len++;
+		}
+		free(old);
+	}
+	for (i = h & c->seen_mask; c->seen[i] != 0; i = (i + 1) & c->seen_mask)
+		if (c->seen[i] == h)
+			return 0;
+	c->seen[i] = h;
+	c->seen_len++;
+	return 1;
+}
+
+/*
+ * Returns the states the key may be in once the n events of ev, sorted by
+ * invocation and overlapping, have taken effect from a state of the mask
+ * from: bit 0 if absent, bit 1 if present. Returns 0 if there is no
+ * linearization, -1 if the search gave up. The search is Wing and Gong's:
+ * an event may take effect next if it was invoked before every event
+ * left responded. As in Lowe's variant, the events not taken yet are
+ * kept in a list, and nodes of the search, the events taken and the
+ * state, are explored only once.
+ */
+static int check_chunk(check_search_t *c, const bench_event_t *ev, long n, int from)
+{
+	check_frame_t *f, *g;
+	long i, depth;
+	int s0, t, r, found = 0;
+
+	if (n + 1 > c->cap) {
+		c->cap = 2 * (n + 1);
+		free(c->next);
+		free(c->prev);
+		free(c->stack);
+		if ((c->next = (long *)malloc(c->cap * sizeof(long))) == NULL ||
+		    (c->prev = (long *)malloc(c->cap * sizeof(long))) == NULL ||
+		    (c->stack = (check_frame_t *)malloc(c->cap * sizeof(check_frame_t))) == NULL) {
+			perror("malloc");
+			exit(1);
+		}
+	}
+	for (i = 0; i <= n; i++) {
+		c->next[i] = (i + 1) % (n + 1);
+		c->prev[i] = (i + n) % (n + 1);
+	}
+	check_seen_reset(c, 64);
+
+	for (s0 = 0; s0 < 2; s0++) {
+		if ((from & (1 << s0)) == 0)
+			continue;
+		f = &c->stack[0];
+		f->i = -1;
+		f->hash = 0;
+		f->s = s0;
+		depth = 0;
+		while (depth >= 0) {
+			f = &c->stack[depth];
+			if (f->i < 0) {
+				if (depth == n) {
+					if ((found |= 1 << f->s) == 3)
+						return found;
+					depth--;
+					continue;
+				}
+				if ((r = check_visit(c, check_mix(f->hash ^ (uint64_t)f->s))) <= 0) {
+					if (r < 0)
+						return -1;
+					depth--;
+					continue;
+				}
+				i = c->next[n];
+				f->cutoff = UINT64_MAX;
+			} else {
+				/* Put back the event the last try took */
+				c->next[c->prev[f->i]] = f->i;
+				c->prev[c->next[f->i]] = f->i;
+				i = c->next[f->i];
+			}
+			t = -1;
+			for (; i != n && ev[i].call <= f->cutoff; i = c->next[i]) {
+				if (ev[i].ret < f->cutoff)
+					f->cutoff = ev[i].ret;
+				if ((t = check_apply(&ev[i], f->s)) >= 0)
+					break;
+			}
+			if (t < 0) {
+				depth--;
+				continue;
+			}
+			f->i = i;
+			c->next[c->prev[i]] = c->next[i];
+			c->prev[c->next[i]] = c->prev[i];
+			g = f + 1;
+			g->i = -1;
+			g->hash = f->hash ^ check_mix((uint64_t)i + 1);
+			g->s = t;
+			depth++;
+		}
+	}
+	return found;
+}
+
+/*
+ * Checks the subhistory of a key chunk by chunk, a chunk ending where no
+ * event overlaps the next one. The state before the first event is not
+ * known, the one after the last must be k->final.
+ */
+static int check_key(check_search_t *c, const bench_event_t *ev, check_key_t *k)
+{
+	long start, end;
+	uint64_t last;
+	int states = 3;
+
+	for (start = k->start; start < k->end; start = end) {
+		last = ev[start].ret;
+		for (end = start + 1; end < k->end && ev[end].call <= last; end++)
+			if (ev[end].ret > last)
+				last = ev[end].ret;
+		if ((states = check_chunk(c, ev + start, end - start, states)) <= 0) {
+			k->bad_start = start;
+			k->bad_end = end;
+			return (states < 0 ? CHECK_UNKNOWN : CHECK_FAILED);
+		}
+	}
+	return ((states & (1 << k->final)) != 0 ? CHECK_OK : CHECK_FINAL);
+}
+
+static void *check_run(void *arg)
+{
+	check_job_t *job = (check_job_t *)arg;
+	check_search_t c;
+	long k;
+
+	memset(&c, 0, sizeof(c));
+	while ((k = (long)AO_fetch_and_add1_full(&job->next)) < job->nb_keys)
+		job->keys[k].result = check_key(&c, job->ev, &job->keys[k]);
+	free(c.next);
+	free(c.prev);
+	free(c.stack);
+	free(c.seen);
+	return NULL;
+}
+
+static void check_report(const bench_event_t *ev, const check_key_t *k, uint64_t t0)
+{
+	long i;
+
+	if (k->result == CHECK_FINAL) {
+		printf("ERROR: Key %ld is %s the set after the run, no linearization leaves it so\n",
+		       (long)ev[k->start].key, k->final ? "in" : "not in");
+		return;
+	}
+	printf("%s: Key %ld, %s %ld overlapping operations:\n",
+	       k->result == CHECK_FAILED ? "ERROR" : "WARNING", (long)ev[k->start].key,
+	       k->result == CHECK_FAILED ? "no linearization of" : "search gave up on",
+	       k->bad_end - k->bad_start);
+	for (i = k->bad_start; i < k->bad_end && i < k->bad_start + CHECK_REPORT_EVENTS; i++)
+		printf("  thread %-3d %-8s %-4s [%lu, %lu] ns\n", ev[i].thread,
+		       op_names[ev[i].op], ev[i].ok ? "ok" : "fail",
+		       (unsigned long)(ev[i].call - t0), (unsigned long)(ev[i].ret - t0));
+	if (k->bad_end - k->bad_start > CHECK_REPORT_EVENTS)
+		printf("  ...\n");
+}
+
+/*
+ * Checks the history of the run (-C) with as many threads as workers.
+ * The keys' final state is read from the set by the calling thread.
+ */
+static void check_history(void *set, const bench_ops_t *ops, const bench_config_t *cfg,
+			  const thread_data_t *data)
+{
+	bench_event_t *ev;
+	check_job_t job;
+	check_key_t *keys;
+	thread_data_t d;
+	pthread_t *threads;
+	uint64_t t0, start;
+	long i, total = 0, reported = 0;
+	int j;
+
+	start = now_ns();
+	t0 = UINT64_MAX;
+	for (j = 0; j < cfg->nb_threads; j++) {
+		total += data[j].history_len;
+		if (data[j].start_ns < t0)
+			t0 = data[j].start_ns;
+	}
+	if ((ev = (bench_event_t *)malloc((total + 1) * sizeof(bench_event_t))) == NULL ||
+	    (keys = (check_key_t *)malloc((total + 1) * sizeof(check_key_t))) == NULL ||
+	    (threads = (pthread_t *)malloc(cfg->nb_threads * sizeof(pthread_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	for (i = 0, j = 0; j < cfg->nb_threads; j++) {
+		memcpy(ev + i, data[j].history, data[j].history_len * sizeof(bench_event_t));
+		i += data[j].history_len;
+	}
+	qsort(ev, total, sizeof(bench_event_t), event_cmp);
+
+	/* The set is not accessed concurrently, as when populating it */
+	thread_data_init(&d, cfg->nb_threads, cfg, ops, set, NULL);
+	d.unit_tx = 0;
+	if (ops->thread_enter != NULL)
+		ops->thread_enter(set, &d);
+	job.nb_keys = 0;
+	for (i = 0; i < total; i++) {
+		if (i > 0 && ev[i].key == ev[i - 1].key)
+			continue;
+		if (job.nb_keys > 0)
+			keys[job.nb_keys - 1].end = i;
+		keys[job.nb_keys].start = i;
+		keys[job.nb_keys].final = (ops->contains(set, ev[i].key, &d) != 0);
+		keys[job.nb_keys].result = CHECK_OK;
+		job.nb_keys++;
+	}
+	if (job.nb_keys > 0)
+		keys[job.nb_keys - 1].end = total;
+	if (ops->thread_exit != NULL)
+		ops->thread_exit(set, &d);
+
+	job.ev = ev;
+	job.keys = keys;
+	job.next = 0;
+	for (j = 0; j < cfg->nb_threads; j++) {
+		if (pthread_create(&threads[j], NULL, check_run, &job) != 0) {
+			fprintf(stderr, "Error creating thread\n");
+			exit(1);
+		}
+	}
+	for (j = 0; j < cfg->nb_threads; j++) {
+		if (pthread_join(threads[j], NULL) != 0) {
+			fprintf(stderr, "Error waiting for thread completion\n");
+			exit(1);
+		}
+	}
+
+	check_failed = 0;
+	check_unknown = 0;
+	for (i = 0; i < job.nb_keys; i++) {
+		if (keys[i].result == CHECK_OK)
+			continue;
+		if (keys[i].result == CHECK_UNKNOWN)
+			check_unknown++;
+		else
+			check_failed++;
+		if (reported++ < CHECK_REPORT_KEYS)
+			check_report(ev, &keys[i], t0);
+	}
+	printf("Linearizable  : %s, %ld ops on %ld keys", check_failed > 0 ? "NO" : "yes",
+	       total, job.nb_keys);
+	if (check_failed > 0)
+		printf(", %ld keys failed", check_failed);
+	if (check_unknown > 0)
+		printf(", %ld keys undecided", check_unknown);
+	printf(" (checked in %.3f ms)\n", (now_ns() - start) / 1e6);
+
+	free(threads);
+	free(keys);
+	free(ev);
+}
+
+/*
+ * Reads the resident set from /proc and the heap in use from the
+ * allocator; the latter is -1 unless glibc's malloc is the one in use,
+ * as an interposed allocator (MALLOC=TC) leaves its counters still.
+ */
+static void mem_read(mem_usage_t *m)
+{
+	long pages, resident;
+	FILE *f;
+
+	m->rss = -1;
+	if ((f = fopen("/proc/self/statm", "r")) != NULL) {
+		if (fscanf(f, "%ld %ld", &pages, &resident) == 2)
+			m->rss = resident * sysconf(_SC_PAGESIZE);
+		fclose(f);
+	}
+	m->heap = -1;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	{
+		struct mallinfo2 mi = mallinfo2();
+
+		m->heap = (long)(mi.uordblks + mi.hblkhd);
+	}
+#endif
+}
+
+/* Records the current footprint if it is the highest of the run so far */
+static void mem_sample(void)
+{
+	mem_usage_t m;
+
+	mem_read(&m);
+	if (m.rss > mem_peak.rss)
+		mem_peak.rss = m.rss;
+	if (m.heap > mem_peak.heap)
+		mem_peak.heap = m.heap;
+}
+
+/*
+ * Footprint of the run: the process as a whole, from before the set was
+ * created, and the set itself as its structure counts it. Per element
+ * figures divide by the size of the set at that point. Without garbage
+ * collection between samples, the peak above the populated heap is what
+ * the run held in retired nodes, plus any growth of the set.
+ */
+static void print_memory(const bench_ops_t *ops, long size)
+{
+	long grown;
+
+	printf("Memory (MB)   : rss %.3f, populated +%.3f (%.1f B/element), peak %.3f\n",
+	       mem_end.rss / 1048576.0, (mem_populated.rss - mem_base.rss) / 1048576.0,
+	       (double)(mem_populated.rss - mem_base.rss) / (populated_size > 0 ? populated_size : 1),
+	       mem_peak.rss / 1048576.0);
+	if (mem_populated.heap > mem_base.heap) {
+		grown = mem_peak.heap - mem_populated.heap;
+		printf("Heap (MB)     : in use %.3f, populated +%.3f (%.1f B/element), peak %.3f, +%.3f above populated\n",
+		       mem_end.heap / 1048576.0,
+		       (mem_populated.heap - mem_base.heap) / 1048576.0,
+		       (double)(mem_populated.heap - mem_base.heap) / (populated_size > 0 ? populated_size : 1),
+		       mem_peak.heap / 1048576.0, (grown > 0 ? grown : 0) / 1048576.0);
+	}
+	if (ops->memory != NULL)
+		printf("Set memory    : %ld nodes, %ld index nodes, %.3f MB (%.1f B/element), %ld retired, %.3f MB\n",
+		       set_mem.nodes, set_mem.index_nodes, set_mem.bytes / 1048576.0,
+		       (double)set_mem.bytes / (size > 0 ? size : 1),
+		       set_mem.retired, set_mem.retired_bytes / 1048576.0);
+}
+
+/*
+ * Counters of a running thread. Each is only written by its owner and
+ * word-sized, so a concurrent read returns a recent, if not exact, value.
+ */
+#define PEEK(x)                         (*(volatile unsigned long *)&(x))
+
+static unsigned long peek_ops(thread_data_t *d, unsigned long *upd)
+{
+	*upd = PEEK(d->nb_added) + PEEK(d->nb_removed) + PEEK(d->nb_moved) +
+		PEEK(d->nb_overwritten);
+	return PEEK(d->nb_add) + PEEK(d->nb_remove) + PEEK(d->nb_contains) +
+		PEEK(d->nb_move) + PEEK(d->nb_snapshot) + PEEK(d->nb_range) +
+		PEEK(d->nb_overwrite);
+}
+
+/* All the latencies recorded so far, all threads and operations merged */
+static void peek_latency(bench_hist_t *to, thread_data_t *data, int nb_threads)
+{
+	const bench_hist_t *h;
+	int i, j, k;
+
+	memset(to, 0, sizeof(bench_hist_t));
+	for (i = 0; i < nb_threads; i++) {
+		for (j = 0; j < 2 * NB_OPS; j++) {
+			h = &data[i].lat[j];
+			for (k = 0; k < HIST_BUCKETS; k++)
+				to->buckets[k] += PEEK(h->buckets[k]);
+		}
+	}
+}
+
+/* Operations and effective updates of all threads so far */
+static void phase_peek(thread_data_t *data, int nb_threads, unsigned long *ops,
+		       unsigned long *upd)
+{
+	unsigned long u;
+	int i;
+
+	*ops = *upd = 0;
+	for (i = 0; i < nb_threads; i++) {
+		*ops += peek_ops(&data[i], &u);
+		*upd += u;
+	}
+}
+
+/* Starts timing the first phase of the script at t */
+static void phase_start(thread_data_t *data, const bench_config_t *cfg, uint64_t t)
+{
+	if (cfg->latency > 0) {
+		if ((phase_lat = (bench_hist_t *)calloc(3, sizeof(bench_hist_t))) == NULL) {
+			perror("malloc");
+			exit(1);
+		}
+		peek_latency(&phase_lat[0], data, cfg->nb_threads);
+	}
+	phase_peek(data, cfg->nb_threads, &phase_ops, &phase_upd);
+	phase_start_ns = t;
+	phase_end = t + (uint64_t)phases[0].duration * 1000000;
+}
+
+/*
+ * Ends the current phase at t, measures it and starts the next one if
+ * any. Phases end on the schedule of the script, not a duration after
+ * the main thread noticed the previous one was over.
+ */
+static void phase_next(thread_data_t *data, const bench_config_t *cfg, uint64_t t)
+{
+	phase_t *p = &phases[phase_cur];
+	unsigned long ops, upd;
+
+	phase_peek(data, cfg->nb_threads, &ops, &upd);
+	p->ns = t - phase_start_ns;
+	p->ops = ops - phase_ops;
+	p->upd = upd - phase_upd;
+	phase_ops = ops;
+	phase_upd = upd;
+	if (phase_lat != NULL) {
+		peek_latency(&phase_lat[1], data, cfg->nb_threads);
+		hist_diff(&phase_lat[2], &phase_lat[1], &phase_lat[0]);
+		memcpy(&phase_lat[0], &phase_lat[1], sizeof(bench_hist_t));
+		if (phase_lat[2].count > 0) {
+			p->p50 = hist_percentile(&phase_lat[2], 50.0);
+			p->p99 = hist_percentile(&phase_lat[2], 99.0);
+		}
+	}
+	if ((int)phase_cur + 1 == nb_phases) {
+		phase_end = UINT64_MAX;
+		return;
+	}
+	phase_start_ns = t;
+	phase_end += (uint64_t)p[1].duration * 1000000;
+	AO_store_full(&phase_cur, phase_cur + 1);
+}
+
+/* A wait of t ns from now, cut at the end of the current phase */
+static inline uint64_t phase_cut(uint64_t now, uint64_t t)
+{
+	if (nb_phases == 0 || now + t <= phase_end)
+		return t;
+	return (phase_end > now ? phase_end - now : 0);
+}
+
+/*
+ * Runs for the duration of the benchmark (or until a signal if 0) and
+ * prints one line per interval (-I): throughput, effective updates, the
+ * number of threads that completed no operation, hinting at a stall, and
+ * the latency percentiles of the interval if latencies are sampled.
+ */
+static void sample_run(thread_data_t *data, const bench_config_t *cfg)
+{
+	unsigned long *prev, ops, upd, ops_sum, upd_sum;
+	bench_hist_t *lat = NULL;
+	struct timespec ts;
+	uint64_t t, t_start, t_prev, t_end;
+	int i, idle, timed, n = cfg->nb_threads;
+
+	if ((prev = (unsigned long *)calloc(2 * n, sizeof(unsigned long))) == NULL ||
+	    (cfg->latency > 0 &&
+	     (lat = (bench_hist_t *)calloc(3, sizeof(bench_hist_t))) == NULL)) {
+		perror("malloc");
+		exit(1);
+	}
+	printf("Time series  : every %d ms\n", cfg->interval);
+	printf("  %10s", "time(ms)");
+	if (nb_phases > 0)
+		printf(" %5s", "phase");
+	printf(" %12s %12s %5s", "ops/s", "effupd/s", "idle");
+	if (lat != NULL)
+		printf(" %10s %10s %10s", "p50(ns)", "p99(ns)", "max(ns)");
+	printf("\n");
+
+	t_start = t_prev = now_ns();
+	t_end = t_start + (uint64_t)cfg->duration * 1000000;
+	if (nb_phases > 0)
+		phase_start(data, cfg, t_start);
+	/* With a fixed op count, run until the last thread is done */
+	timed = (!fixed_ops && cfg->duration > 0);
+	while (!timed || t_prev < t_end) {
+		t = (uint64_t)cfg->interval * 1000000;
+		if (timed && t_prev + t > t_end)
+			t = t_end - t_prev;
+		/* An interval does not straddle two phases */
+		t = phase_cut(t_prev, t);
+		ts.tv_sec = t / 1000000000;
+		ts.tv_nsec = t % 1000000000;
+		/* A signal ends the run, as in the unsampled case */
+		if (nanosleep(&ts, NULL) != 0)
+			break;
+		t = now_ns();
+
+		ops_sum = upd_sum = 0;
+		idle = 0;
+		for (i = 0; i < n; i++) {
+			ops = peek_ops(&data[i], &upd);
+			/* Threads parked by the phase are not stalled */
+			if (ops == prev[2 * i] &&
+			    (nb_phases == 0 || i < phases[phase_cur].nb_threads))
+				idle++;
+			ops_sum += ops - prev[2 * i];
+			upd_sum += upd - prev[2 * i + 1];
+			prev[2 * i] = ops;
+			prev[2 * i + 1] = upd;
+		}
+		printf("  %10.1f", (t - t_start) / 1e6);
+		if (nb_phases > 0)
+			printf(" %5lu", (unsigned long)phase_cur);
+		printf(" %12.0f %12.0f %5d",
+		       ops_sum * 1e9 / (t - t_prev),
+		       upd_sum * 1e9 / (t - t_prev), idle);
+		if (lat != NULL) {
+			peek_latency(&lat[1], data, n);
+			hist_diff(&lat[2], &lat[1], &lat[0]);
+			memcpy(&lat[0], &lat[1], sizeof(bench_hist_t));
+			if (lat[2].count > 0)
+				printf(" %10lu %10lu %10lu",
+				       (unsigned long)hist_percentile(&lat[2], 50.0),
+				       (unsigned long)hist_percentile(&lat[2], 99.0),
+				       (unsigned long)lat[2].max);
+			else
+				printf(" %10s %10s %10s", "-", "-", "-");
+		}
+		printf("\n");
+		fflush(stdout);
+		mem_sample();
+		if (nb_phases > 0 && t >= phase_end)
+			phase_next(data, cfg, t);
+		t_prev = t;
+		if (fixed_ops && AO_load_full(&nb_running) == 0)
+			break;
+	}
+	free(lat);
+	free(prev);
+}
+
+/*
+ * Waits for the end of the run while sampling the footprint: for the
+ * duration of the benchmark, until a signal if 0, or until the threads
+ * stop by themselves with a fixed op count. Starts the phases of the
+ * script on time, if any.
+ */
+static void wait_run(thread_data_t *data, const bench_config_t *cfg)
+{
+	struct timespec ts;
+	uint64_t t, now, t_next, t_end;
+
+	t_next = now_ns() + (uint64_t)MEM_SAMPLE_MS * 1000000;
+	if (fixed_ops) {
+		/* Sleeps rather than yields, not to take a CPU from the workers */
+		ts.tv_sec = MEM_SAMPLE_MS / 1000;
+		ts.tv_nsec = (MEM_SAMPLE_MS % 1000) * 1000000;
+		while (AO_load_full(&nb_running) > 0) {
+			nanosleep(&ts, NULL);
+			mem_sample();
+		}
+		return;
+	}
+	t_end = t_next - (uint64_t)MEM_SAMPLE_MS * 1000000 + (uint64_t)cfg->duration * 1000000;
+	if (nb_phases > 0)
+		phase_start(data, cfg, t_end - (uint64_t)cfg->duration * 1000000);
+	for (;;) {
+		t = (uint64_t)MEM_SAMPLE_MS * 1000000;
+		if (cfg->duration > 0) {
+			if ((now = now_ns()) >= t_end)
+				break;
+			if (t_end - now < t)
+				t = t_end - now;
+			t = phase_cut(now, t);
+		}
+		ts.tv_sec = t / 1000000000;
+		ts.tv_nsec = t % 1000000000;
+		/* Interrupted by the signal that ends an untimed run */
+		if (nanosleep(&ts, NULL) != 0)
+			break;
+		if (nb_phases > 0 && (now = now_ns()) >= phase_end)
+			phase_next(data, cfg, now);
+		mem_sample();
+	}
+}
+
+static bench_perf_t *perf_alloc(void)
+{
+	bench_perf_t *p;
+
+	if ((p = (bench_perf_t *)malloc(sizeof(bench_perf_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	return p;
+}
+
+/*
+ * Window during which the workers ran, from the first one to leave the
+ * start barrier to the last one to stop, as timestamped by themselves.
+ */
+static uint64_t run_window(const thread_data_t *data, int nb_threads)
+{
+	uint64_t first = data[0].start_ns, last = 0;
+	int i;
+
+	for (i = 0; i < nb_threads; i++) {
+		if (data[i].start_ns < first)
+			first = data[i].start_ns;
+		if (data[i].start_ns + data[i].elapsed_ns > last)
+			last = data[i].start_ns + data[i].elapsed_ns;
+	}
+	return last - first;
+}
+
+/*
+ * Spread of the workers' start times, and time each took to complete its
+ * operations. Skew compares the first and the last thread to finish, a
+ * fair run keeps it low.
+ */
+static void print_completion(const thread_data_t *data, const bench_config_t *cfg)
+{
+	uint64_t min = data[0].elapsed_ns, max = data[0].elapsed_ns;
+	uint64_t first = data[0].start_ns, last = data[0].start_ns;
+	int i;
+
+	for (i = 1; i < cfg->nb_threads; i++) {
+		if (data[i].elapsed_ns < min)
+			min = data[i].elapsed_ns;
+		if (data[i].elapsed_ns > max)
+			max = data[i].elapsed_ns;
+		if (data[i].start_ns < first)
+			first = data[i].start_ns;
+		if (data[i].start_ns > last)
+			last = data[i].start_ns;
+	}
+	printf("Start spread  : %.3f us\n", (last - first) / 1e3);
+	printf("Completion    : first %.3f ms, last %.3f ms, skew %.2f%%\n",
+	       min / 1e6, max / 1e6, max > 0 ? 100.0 * (max - min) / max : 0.0);
+}
+
+/*
+ * Rate the threads sustained against the one they were asked for (-Q),
+ * and how far behind their schedule the furthest one was at the end: a
+ * thread that cannot keep up issues back to back and falls behind.
+ */
+static void print_schedule(const thread_data_t *data, const bench_config_t *cfg)
+{
+	unsigned long ops = 0;
+	uint64_t behind = 0;
+	int i;
+
+	for (i = 0; i < cfg->nb_threads; i++) {
+		ops += data[i].nb_add + data[i].nb_remove + data[i].nb_contains +
+			data[i].nb_move + data[i].nb_snapshot + data[i].nb_range +
+			data[i].nb_overwrite;
+		if (data[i].behind_ns > behind)
+			behind = data[i].behind_ns;
+	}
+	printf("Schedule      : %ld ops/s per thread (%s), achieved %.0f, %.3f ms behind at the end\n",
+	       cfg->rate, arrival_names[cfg->arrivals],
+	       ops * 1e9 / cfg->elapsed_ns / cfg->nb_threads, behind / 1e6);
+}
+
+/*
+ * Throughput of each phase of the script, over the time the main thread
+ * ran it. Phases a signal cut short were not measured.
+ */
+static void print_phases(const bench_config_t *cfg)
+{
+	const phase_t *p;
+	int i;
+
+	printf("Phases        : %s\n", cfg->phases);
+	printf("  %5s %9s %7s %6s %-16s %6s %12s %12s", "phase", "time(ms)",
+	       "threads", "update", "distribution", "offset", "ops/s", "effupd/s");
+	if (cfg->latency > 0)
+		printf(" %10s %10s", "p50(ns)", "p99(ns)");
+	printf("\n");
+	for (i = 0; i < nb_phases; i++) {
+		p = &phases[i];
+		printf("  %5d", i);
+		if (p->ns == 0) {
+			printf(" %9s\n", "-");
+			continue;
+		}
+		printf(" %9.1f %7d %6d %-16s %6d %12.0f %12.0f", p->ns / 1e6,
+		       p->nb_threads, p->update, p->dist_name, p->offset,
+		       p->ops * 1e9 / p->ns, p->upd * 1e9 / p->ns);
+		if (cfg->latency > 0 && p->p99 > 0)
+			printf(" %10lu %10lu", (unsigned long)p->p50, (unsigned long)p->p99);
+		else if (cfg->latency > 0)
+			printf(" %10s %10s", "-", "-");
+		printf("\n");
+	}
+}
+
+/* Sum of the threads' counts of event i, PERF_NA if any thread lacks it */
+static uint64_t perf_total(const thread_data_t *data, int nb_threads, int i)
+{
+	uint64_t total = 0;
+	int j;
+
+	for (j = 0; j < nb_threads; j++) {
+		if (data[j].perf->count[i] == PERF_NA)
+			return PERF_NA;
+		total += data[j].perf->count[i];
+	}
+	return total;
+}
+
+static void print_perf(const thread_data_t *data, const bench_config_t *cfg,
+		       unsigned long txs)
+{
+	uint64_t v;
+	int i, n = 0;
+
+	printf("Perf counters : total, per op\n");
+	for (i = 0; i < NB_PERF; i++) {
+		v = perf_total(data, cfg->nb_threads, i);
+		if (v == PERF_NA) {
+			printf("  %-14s: n/a\n", perf_names[i]);
+			continue;
+		}
+		printf("  %-14s: %lu, %.3f\n", perf_names[i], (unsigned long)v,
+		       txs > 0 ? (double)v / txs : 0.0);
+		n++;
+	}
+	if (n == 0)
+		printf("  (perf_event_open failed, check kernel.perf_event_paranoid)\n");
+}
+
+/*
+ * Result record writer. CSV records are written twice, once for the
+ * header (keys only) and once for the values, so both stay in sync.
+ */
+typedef struct record {
+	FILE *f;
+	int fmt;
+	int header;
+	int nb_fields;
+} record_t;
+
+static void rec_key(record_t *r, const char *key)
+{
+	if (r->nb_fields++ > 0)
+		fputc(',', r->f);
+	if (r->fmt == OUT_JSON)
+		fprintf(r->f, "\"%s\":", key);
+	else if (r->header)
+		fputs(key, r->f);
+}
+
+static void rec_str(record_t *r, const char *key, const char *v)
+{
+	rec_key(r, key);
+	if (r->fmt == OUT_CSV && r->header)
+		return;
+	fputc('"', r->f);
+	for (; *v != '\0'; v++) {
+		if (*v == '"')
+			fputc(r->fmt == OUT_JSON ? '\\' : '"', r->f);
+		else if (*v == '\\' && r->fmt == OUT_JSON)
+			fputc('\\', r->f);
+		fputc(*v, r->f);
+	}
+	fputc('"', r->f);
+}
+
+static void rec_long(record_t *r, const char *key, long v)
+{
+	rec_key(r, key);
+	if (r->fmt == OUT_JSON || !r->header)
+		fprintf(r->f, "%ld", v);
+}
+
+static void rec_ulong(record_t *r, const char *key, unsigned long v)
+{
+	rec_key(r, key);
+	if (r->fmt == OUT_JSON || !r->header)
+		fprintf(r->f, "%lu", v);
+}
+
+static void rec_double(record_t *r, const char *key, double v)
+{
+	rec_key(r, key);
+	if (r->fmt == OUT_JSON || !r->header)
+		fprintf(r->f, "%.3f", v);
+}
+
+/*
+ * Writes the fields of one run: the parameters, the totals and, in JSON
+ * only as CSV has a fixed set of columns, the per-thread counters.
+ */
+static void rec_fields(record_t *r, const char *bench, const bench_ops_t *ops,
+		       const bench_config_t *cfg, const thread_data_t *data,
+		       long size, long expected)
+{
+	const bench_option_t *opt;
+	const thread_data_t *d;
+	const phase_t *p;
+	unsigned long reads = 0, updates = 0, effupds = 0, snapshots = 0,
+		ranges = 0, range_keys = 0, moves = 0, overwrites = 0,
+		value_errors = 0, preempted = 0, aborts = 0, max_retries = 0,
+		failures = 0;
+	double secs = cfg->elapsed_ns / 1e9;
+	bench_hist_t lat;
+	uint64_t v;
+	int i, j;
+
+	for (i = 0; i < cfg->nb_threads; i++) {
+		d = &data[i];
+		reads += d->nb_contains;
+		updates += d->nb_add + d->nb_remove + d->nb_move + d->nb_overwrite;
+		effupds += d->nb_added + d->nb_removed + d->nb_moved + d->nb_overwritten;
+		moves += d->nb_move;
+		overwrites += d->nb_overwrite;
+		value_errors += d->nb_value_errors;
+		snapshots += d->nb_snapshot;
+		ranges += d->nb_range;
+		range_keys += d->nb_range_keys;
+		aborts += d->nb_aborts;
+		failures += d->failures_because_contention;
+		preempted += d->nb_preempted;
+		if (max_retries < d->max_retries)
+			max_retries = d->max_retries;
+	}
+
+	rec_str(r, "bench", bench);
+	rec_str(r, "set", ops->name);
+	rec_str(r, "flavor", BENCH_FLAVOR);
+	rec_double(r, "duration_ms", cfg->elapsed_ns / 1e6);
+	rec_long(r, "initial", cfg->initial);
+	rec_long(r, "threads", cfg->nb_threads);
+	rec_long(r, "range", cfg->range);
+	rec_long(r, "seed", cfg->seed);
+	rec_long(r, "update", cfg->update);
+	rec_long(r, "move", cfg->move);
+	rec_long(r, "snapshot", cfg->snapshot);
+	if (ops->range != NULL) {
+		rec_long(r, "range_rate", cfg->range_rate);
+		rec_long(r, "range_length", cfg->range_len);
+		rec_str(r, "range_mode", cfg->range_count ? "count" : "collect");
+		rec_str(r, "range_consistency", ops->range_linearizable ? "linearizable" : "weak");
+	}
+	if (ops->get != NULL) {
+		rec_long(r, "value_size", cfg->value_size);
+		rec_long(r, "overwrite", cfg->overwrite);
+	}
+	rec_long(r, "elasticity", cfg->unit_tx);
+	rec_long(r, "alternate", cfg->alternate);
+	rec_long(r, "growth", cfg->growth);
+	rec_long(r, "effective", cfg->effective);
+	rec_long(r, "unbalanced", cfg->unbalanced);
+	rec_long(r, "mono_int", cfg->mono_int);
+	rec_long(r, "reverse_int", cfg->reverse_int);
+	rec_long(r, "bias_range", cfg->bias_range);
+	rec_long(r, "bias_offset", cfg->bias_offset);
+	rec_str(r, "distribution", dist_names[cfg->dist]);
+	rec_double(r, "theta", cfg->theta);
+	rec_long(r, "hot_ops", cfg->hot_ops);
+	rec_long(r, "hot_keys", cfg->hot_keys);
+	rec_long(r, "key_buffer", cfg->key_buffer);
+	rec_long(r, "op_count", cfg->op_count);
+	rec_long(r, "rate", cfg->rate);
+	rec_str(r, "arrivals", arrival_names[cfg->arrivals]);
+	if (nb_phases > 0)
+		rec_str(r, "phases", cfg->phases);
+	rec_long(r, "prefill", cfg->prefill);
+	rec_long(r, "prefill_sorted", cfg->prefill_sorted);
+	rec_long(r, "bulk_build", cfg->bulk);
+	rec_str(r, "pin", cfg->pin == PIN_LIST ? cfg->pin_cpus : pin_names[cfg->pin]);
+	rec_long(r, "oversubscribe", cfg->oversub);
+	rec_long(r, "preempt", cfg->preempt);
+	rec_long(r, "preempt_us", cfg->preempt_us);
+	for (opt = ops->options; opt != NULL && opt->key != 0; opt++)
+		rec_long(r, opt->name, *opt->value);
+	rec_double(r, "prefill_ms", prefill_ns / 1e6);
+	rec_long(r, "size", size);
+	rec_long(r, "expected_size", expected);
+	rec_ulong(r, "txs", reads + updates + snapshots + ranges);
+	rec_double(r, "txs_per_s", (reads + updates + snapshots + ranges) / secs);
+	rec_ulong(r, "contains", reads);
+	rec_ulong(r, "updates", updates);
+	rec_ulong(r, "eff_updates", effupds);
+	rec_double(r, "eff_updates_per_s", effupds / secs);
+	rec_ulong(r, "moves", moves);
+	rec_ulong(r, "snapshots", snapshots);
+	if (ops->range != NULL) {
+		rec_ulong(r, "ranges", ranges);
+		rec_ulong(r, "range_keys", range_keys);
+	}
+	if (ops->get != NULL) {
+		rec_ulong(r, "overwrites", overwrites);
+		rec_ulong(r, "value_errors", value_errors);
+	}
+	rec_ulong(r, "aborts", aborts);
+	rec_double(r, "aborts_per_s", aborts / secs);
+	rec_ulong(r, "max_retries", max_retries);
+	rec_ulong(r, "failures", failures);
+	if (cfg->preempt > 0)
+		rec_ulong(r, "preemptions", preempted);
+	rec_long(r, "rss_bytes", mem_end.rss);
+	rec_long(r, "rss_populated_bytes", mem_populated.rss - mem_base.rss);
+	rec_long(r, "rss_peak_bytes", mem_peak.rss);
+	rec_long(r, "heap_bytes", mem_end.heap);
+	rec_long(r, "heap_populated_bytes", mem_populated.heap - mem_base.heap);
+	rec_long(r, "heap_peak_bytes", mem_peak.heap);
+	if (ops->memory != NULL) {
+		rec_long(r, "set_nodes", set_mem.nodes);
+		rec_long(r, "set_index_nodes", set_mem.index_nodes);
+		rec_long(r, "set_bytes", set_mem.bytes);
+		rec_double(r, "bytes_per_element", (double)set_mem.bytes / (size > 0 ? size : 1));
+		rec_long(r, "set_retired", set_mem.retired);
+		rec_long(r, "set_retired_bytes", set_mem.retired_bytes);
+	}
+	if (cfg->check) {
+		rec_long(r, "check_failed_keys", check_failed);
+		rec_long(r, "check_undecided_keys", check_unknown);
+	}
+	/* All operations merged, for rate/SLO searches */
+	if (cfg->latency > 0) {
+		memset(&lat, 0, sizeof(lat));
+		for (i = 0; i < cfg->nb_threads; i++)
+			for (j = 0; j < 2 * NB_OPS; j++)
+				hist_merge(&lat, &data[i].lat[j]);
+		rec_ulong(r, "lat_p50_ns", (unsigned long)hist_percentile(&lat, 50.0));
+		rec_ulong(r, "lat_p99_ns", (unsigned long)hist_percentile(&lat, 99.0));
+		rec_ulong(r, "lat_p999_ns", (unsigned long)hist_percentile(&lat, 99.9));
+		rec_ulong(r, "lat_max_ns", (unsigned long)lat.max);
+	}
+	/* Empty (CSV) or null (JSON) for unavailable events */
+	for (i = 0; cfg->perf && i < NB_PERF; i++) {
+		rec_key(r, perf_names[i]);
+		if (r->fmt == OUT_CSV && r->header)
+			continue;
+		v = perf_total(data, cfg->nb_threads, i);
+		if (v != PERF_NA)
+			fprintf(r->f, "%lu", (unsigned long)v);
+		else if (r->fmt == OUT_JSON)
+			fputs("null", r->f);
+	}
+	if (r->fmt != OUT_JSON)
+		return;
+
+	if (nb_phases > 0) {
+		rec_key(r, "per_phase");
+		fputc('[', r->f);
+		for (i = 0; i < nb_phases; i++) {
+			p = &phases[i];
+			fprintf(r->f, "%s{", i > 0 ? "," : "");
+			r->nb_fields = 0;
+			rec_long(r, "duration_ms", p->duration);
+			rec_long(r, "threads", p->nb_threads);
+			rec_long(r, "update", p->update);
+			rec_str(r, "distribution", p->dist_name);
+			rec_long(r, "offset", p->offset);
+			rec_double(r, "elapsed_ms", p->ns / 1e6);
+			rec_double(r, "txs_per_s", p->ns > 0 ? p->ops * 1e9 / p->ns : 0.0);
+			rec_double(r, "eff_updates_per_s", p->ns > 0 ? p->upd * 1e9 / p->ns : 0.0);
+			if (cfg->latency > 0) {
+				rec_ulong(r, "lat_p50_ns", (unsigned long)p->p50);
+				rec_ulong(r, "lat_p99_ns", (unsigned long)p->p99);
+			}
+			fputc('}', r->f);
+		}
+		fputc(']', r->f);
+	}
+
+	rec_key(r, "per_thread");
+	fputc('[', r->f);
+	for (i = 0; i < cfg->nb_threads; i++) {
+		d = &data[i];
+		fprintf(r->f, "%s{", i > 0 ? "," : "");
+		r->nb_fields = 0;
+		rec_ulong(r, "add", d->nb_add);
+		rec_ulong(r, "added", d->nb_added);
+		rec_ulong(r, "remove", d->nb_remove);
+		rec_ulong(r, "removed", d->nb_removed);
+		rec_ulong(r, "contains", d->nb_contains);
+		rec_ulong(r, "found", d->nb_found);
+		rec_ulong(r, "move", d->nb_move);
+		rec_ulong(r, "moved", d->nb_moved);
+		rec_ulong(r, "snapshot", d->nb_snapshot);
+		rec_ulong(r, "snapshoted", d->nb_snapshoted);
+		rec_ulong(r, "range", d->nb_range);
+		rec_ulong(r, "ranged", d->nb_ranged);
+		rec_ulong(r, "range_keys", d->nb_range_keys);
+		rec_ulong(r, "overwrite", d->nb_overwrite);
+		rec_ulong(r, "overwritten", d->nb_overwritten);
+		rec_ulong(r, "aborts", d->nb_aborts);
+		rec_ulong(r, "aborts_locked_read", d->nb_aborts_locked_read);
+		rec_ulong(r, "aborts_locked_write", d->nb_aborts_locked_write);
+		rec_ulong(r, "aborts_validate_read", d->nb_aborts_validate_read);
+		rec_ulong(r, "aborts_validate_write", d->nb_aborts_validate_write);
+		rec_ulong(r, "aborts_validate_commit", d->nb_aborts_validate_commit);
+		rec_ulong(r, "aborts_invalid_memory", d->nb_aborts_invalid_memory);
+		rec_ulong(r, "aborts_double_write", d->nb_aborts_double_write);
+		rec_ulong(r, "max_retries", d->max_retries);
+		if (cfg->preempt > 0)
+			rec_ulong(r, "preempted", d->nb_preempted);
+		fputc('}', r->f);
+	}
+	fputc(']', r->f);
+}
+
+/*
+ * Appends the record of the run to the -O file, or prints it last on
+ * stdout: one JSON object per line, or a CSV row preceded by the header
+ * when the file is new.
+ */
+static void print_record(const char *bench, const bench_ops_t *ops,
+			 const bench_config_t *cfg, const thread_data_t *data,
+			 long size, long expected)
+{
+	record_t r;
+	const char *p;
+
+	if ((p = strrchr(bench, '/')) != NULL)
+		bench = p + 1;
+	r.fmt = cfg->output;
+	r.f = stdout;
+	if (cfg->output_file != NULL && (r.f = fopen(cfg->output_file, "a")) == NULL) {
+		perror(cfg->output_file);
+		exit(1);
+	}
+	if (r.fmt == OUT_CSV && (r.f == stdout || ftell(r.f) == 0)) {
+		r.header = 1;
+		r.nb_fields = 0;
+		rec_fields(&r, bench, ops, cfg, data, size, expected);
+		fputc('\n', r.f);
+	}
+	r.header = 0;
+	r.nb_fields = 0;
+	if (r.fmt == OUT_JSON)
+		fputc('{', r.f);
+	rec_fields(&r, bench, ops, cfg, data, size, expected);
+	if (r.fmt == OUT_JSON)
+		fputc('}', r.f);
+	fputc('\n', r.f);
+	if (r.f != stdout)
+		fclose(r.f);
+}
+
+/* Parses the -o format, returns 0 if unknown */
+static int parse_output(bench_config_t *cfg, const char *arg)
+{
+	int i;
+
+	for (i = 0; i < (int)(sizeof(out_names) / sizeof(out_names[0])); i++) {
+		if (strcmp(arg, out_names[i]) == 0) {
+			cfg->output = i;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void catcher(int sig)
+{
+	printf("CAUGHT SIGNAL %d\n", sig);
+}
+
+/* Rejects an option value that makes no sense, release builds drop asserts */
+static void check_arg(int valid, const char *what)
+{
+	if (!valid) {
+		printf("ERROR: Invalid %s\n", what);
+		exit(1);
+	}
+}
+
+static void usage(const bench_ops_t *ops)
+{
+	const bench_option_t *opt;
+
+	printf("intset -- STM stress test "
+	       "(%s)\n"
+	       "\n"
+	       "Usage:\n"
+	       "  intset [options...]\n"
+	       "\n"
+	       "Options:\n"
+	       "  -h, --help\n"
+	       "        Print this message\n"
+	       "  -A, --alternate (default=" XSTR(DEFAULT_ALTERNATE) ")\n"
+	       "        Consecutive insert/remove target the same value\n"
+	       "  -g, --growth <int>\n"
+	       "        Percentage of updates after a successful insert that insert again rather\n"
+	       "        than remove, so that the set grows during the run (default=0)\n"
+	       "  -f, --effective <int>\n"
+	       "        update txs must effectively write (0=trial, 1=effective, default=" XSTR(DEFAULT_EFFECTIVE) ")\n"
+	       "  -d, --duration <int>\n"
+	       "        Test duration in milliseconds (0=infinite, default=" XSTR(DEFAULT_DURATION) ")\n"
+	       "  -i, --initial-size <int>\n"
+	       "        Number of elements to insert before test (default=" XSTR(DEFAULT_INITIAL) ")\n"
+	       "  -t, --thread-num <int>\n"
+	       "        Number of threads (default=" XSTR(DEFAULT_NB_THREADS) ")\n"
+	       "  -M, --oversubscribe <int>\n"
+	       "        Run <int> threads per CPU the process may use, overrides -t, times every op unless -L\n"
+	       "  -y, --preempt <n>[:<us>]\n"
+	       "        Deschedule 1 lock holder in <n> of lock-based sets: sleep <us> microseconds,\n"
+	       "        or yield the CPU if 0 or not given\n"
+	       "  -r, --range <int>\n"
+	       "        Range of integer values inserted in set (default=" XSTR(DEFAULT_RANGE) ")\n"
+	       "  -S, --seed <int>\n"
+	       "        RNG seed (0=time-based, default=" XSTR(DEFAULT_SEED) ")\n"
+	       "  -u, --update-rate <int>\n"
+	       "        Percentage of update transactions (default=" XSTR(DEFAULT_UPDATE) ")\n",
+	       ops->name);
+	if (ops->move != NULL)
+		printf("  -a, --move-rate <int>\n"
+		       "        Percentage of move transactions (default=" XSTR(DEFAULT_MOVE) ")\n");
+	if (ops->snapshot != NULL)
+		printf("  -s, --snapshot-rate <int>\n"
+		       "        Percentage of snapshot transactions (default=" XSTR(DEFAULT_SNAPSHOT) ")\n");
+	if (ops->range != NULL)
+		printf("  -q, --range-rate <int>\n"
+		       "        Percentage of range queries, taken from the reads (default=" XSTR(DEFAULT_RANGE_RATE) ")\n"
+		       "  -w, --range-length <int>\n"
+		       "        Number of consecutive keys a range query spans (default=" XSTR(DEFAULT_RANGE_LENGTH) ")\n"
+		       "  -k, --range-count\n"
+		       "        Range queries count the keys rather than collect them\n");
+	if (ops->get != NULL)
+		printf("  -V, --value-size <int>\n"
+		       "        Map mode: each key maps to a value of <int> bytes stored in the structure, from 8\n"
+		       "        to " XSTR(MAX_VALUE_SIZE) " by multiples of 8; adds put, reads get a copy (0=set, default=" XSTR(DEFAULT_VALUE_SIZE) ")\n"
+		       "  -e, --overwrite-rate <int>\n"
+		       "        Map mode: percentage of value overwrites, taken from the updates (default=" XSTR(DEFAULT_OVERWRITE) ")\n");
+	printf("  -x, --elasticity <int>\n"
+	       "        Transaction model or lock algorithm, structure dependent (default=%d)\n",
+	       ops->unit_tx != 0 ? ops->unit_tx : DEFAULT_ELASTICITY);
+	printf("  -U, --unbalance <int>\n"
+	       "        Populate with keys in [1, initial] rather than [1, range] (default=" XSTR(DEFAULT_UNBALANCED) ")\n"
+	       "  -F, --prefill <int>\n"
+	       "        Populate from <int> threads, each adding the keys of its slice of the range\n"
+	       "        (0=from the main thread, default=" XSTR(DEFAULT_PREFILL) ")\n"
+	       "  -Y, --prefill-sorted\n"
+	       "        Populate each slice in increasing key order\n");
+	if (ops->bulk_build != NULL)
+		printf("  -X, --bulk-build\n"
+		       "        Build the initial set at once from its sorted keys, balanced and laid out in key order\n");
+	printf("  -m, --mono-int\n"
+	       "        Populate with monotonically increasing keys\n"
+	       "  -v, --reverse-int\n"
+	       "        Populate with monotonically decreasing keys\n"
+	       "  -b, --bias-range <int>\n"
+	       "        If used, operations take place in range [B, B+b)\n"
+	       "  -B, --bias-offset <int>\n"
+	       "        If used, operations take place in range [B, B+b)\n"
+	       "  -D, --distribution <dist>\n"
+	       "        Key distribution of the operations (default=uniform):\n"
+	       "        uniform,\n"
+	       "        zipf[:<theta>] (0<theta<1, default=" XSTR(DEFAULT_ZIPF_THETA) "),\n"
+	       "        hotspot[:<x>:<y>] (x%% of ops on y%% of keys, default=" XSTR(DEFAULT_HOT_OPS) ":" XSTR(DEFAULT_HOT_KEYS) "),\n"
+	       "        sequential (increasing inserts, uniform reads/removes),\n"
+	       "        latest[:<theta>] (increasing inserts, zipf towards the latest)\n"
+	       "  -K, --key-buffer <int>\n"
+	       "        Pre-generate <int> random keys per thread before the run, used cyclically (0=off, default=" XSTR(DEFAULT_KEY_BUFFER) ")\n"
+	       "  -L, --latency <int>\n"
+	       "        Time 1 op in <int> per thread, print latency percentiles (0=off, default=" XSTR(DEFAULT_LATENCY) ")\n"
+	       "  -Q, --rate <int>\n"
+	       "        Open loop: each thread issues <int> ops per second, latency is timed from when\n"
+	       "        each op was due and every op is timed unless -L is given (0=closed loop, default=" XSTR(DEFAULT_RATE) ")\n"
+	       "  -J, --arrivals <process>\n"
+	       "        Arrivals of the open loop: constant or poisson (default=poisson)\n"
+	       "  -N, --op-count <int>\n"
+	       "        Each thread runs exactly <int> operations, -d is ignored (0=timed run, default=" XSTR(DEFAULT_OP_COUNT) ")\n"
+	       "        Use with -S and -f 0 to replay the same operations across runs\n"
+	       "  -W, --trace-record <file>\n"
+	       "        Record the operations of each thread into a trace\n"
+	       "  -R, --trace-replay <file>\n"
+	       "        Replay a trace instead of generating operations, thread i replays stream i %% #streams\n"
+	       "  -C, --check\n"
+	       "        Log every operation with its invocation and response times and check the run\n"
+	       "        is linearizable; the log is kept in memory, prefer -N or short runs\n"
+	       "  -I, --interval <int>\n"
+	       "        Print throughput (and latency if -L) every <int> milliseconds (0=off, default=" XSTR(DEFAULT_INTERVAL) ")\n"
+	       "  -T, --phases <file>\n"
+	       "        Run the phases of a workload script in turn and print the throughput of each,\n"
+	       "        one phase per line, settings carrying over from the previous one, -d is ignored:\n"
+	       "        <ms> [update=<int>] [dist=<dist>] [offset=<%% of range>] [threads=<int>]\n"
+	       "  -E, --perf\n"
+	       "        Count cycles, instructions, cache and branch misses, context switches per op\n"
+	       "  -o, --output <fmt>\n"
+	       "        Also write a result record: none, json (one object per line) or csv (default=none)\n"
+	       "  -O, --output-file <file>\n"
+	       "        Append the result record to <file> rather than stdout\n"
+	       "  -P, --pin <policy>\n"
+	       "        Pin worker threads to CPUs (default=none):\n"
+	       "        none (let the scheduler place them),\n"
+	       "        compact (fill a socket, one thread per core first),\n"
+	       "        scatter (round-robin over sockets, then cores),\n"
+	       "        smt (fill cores, SMT siblings first),\n"
+	       "        <cpu list> (e.g. 0-3,8, used in order)\n"
+	       "  -G, --pin-bg <cpu list>\n"
+	       "        Pin background/maintenance threads (default=CPUs after the workers' if -P)\n");
+	for (opt = ops->options; opt != NULL && opt->key != 0; opt++)
+		printf("  -%c, --%s <int>\n"
+		       "        %s (default=%d)\n",
+		       opt->key, opt->name, opt->help, *opt->value);
+}
+
+/*
+ * Parses <name>[:<param>...] of -D, returns 0 if unknown or if a
+ * parameter is out of range: theta in (0, 1), for the method of Gray et
+ * al. to hold, and hotspot percentages in [0, 100], of keys above 0.
+ */
+static int parse_dist(bench_config_t *cfg, const char *arg)
+{
+	const char *param = strchr(arg, ':');
+	size_t len = (param != NULL ? (size_t)(param - arg) : strlen(arg));
+	int i;
+
+	for (i = 0; i < (int)(sizeof(dist_names) / sizeof(dist_names[0])); i++)
+		if (strlen(dist_names[i]) == len && strncmp(arg, dist_names[i], len) == 0)
+			break;
+	if (i == (int)(sizeof(dist_names) / sizeof(dist_names[0])))
+		return 0;
+	cfg->dist = i;
+	if (param == NULL)
+		return 1;
+	if (i == DIST_ZIPF || i == DIST_LATEST)
+		return sscanf(param, ":%lf", &cfg->theta) == 1 &&
+			cfg->theta > 0 && cfg->theta < 1;
+	if (i == DIST_HOTSPOT)
+		return sscanf(param, ":%d:%d", &cfg->hot_ops, &cfg->hot_keys) == 2 &&
+			cfg->hot_ops >= 0 && cfg->hot_ops <= 100 &&
+			cfg->hot_keys > 0 && cfg->hot_keys <= 100;
+	return 0;
+}
+
+/*
+ * Loads the workload script of -T, one phase per line:
+ *   <duration ms> [update=<int>] [dist=<dist>] [offset=<int>] [threads=<int>]
+ * update, dist and threads take the values of -u, -D and -t, offset moves
+ * the keys drawn, and so the hot ones, up by that percentage of the range.
+ * A phase keeps the settings it does not give from the previous one, the
+ * first from the command line. Blank lines and # comments are skipped.
+ * The run lasts for the whole script and starts as many threads as its
+ * busiest phase.
+ */
+static void phases_load(bench_config_t *cfg)
+{
+	bench_config_t pc = *cfg;	/* settings of the phase being read */
+	char line[PHASE_LINE], *tok, *val, *end;
+	int lineno = 0, offset = 0;
+	long duration = 0;
+	phase_t *p;
+	FILE *f;
+
+	if ((f = fopen(cfg->phases, "r")) == NULL) {
+		perror(cfg->phases);
+		exit(1);
+	}
+	if ((phases = (phase_t *)calloc(MAX_PHASES, sizeof(phase_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	while (fgets(line, sizeof(line), f) != NULL) {
+		lineno++;
+		if ((tok = strchr(line, '#')) != NULL)
+			*tok = '\0';
+		if ((tok = strtok(line, " \t\r\n")) == NULL)
+			continue;
+		if (nb_phases == MAX_PHASES) {
+			printf("ERROR: %s: more than %d phases\n", cfg->phases, MAX_PHASES);
+			exit(1);
+		}
+		p = &phases[nb_phases];
+		p->duration = (int)strtol(tok, &end, 10);
+		if (*end != '\0' || p->duration <= 0)
+			goto bad;
+		while ((tok = strtok(NULL, " \t\r\n")) != NULL) {
+			if ((val = strchr(tok, '=')) == NULL)
+				goto bad;
+			*val++ = '\0';
+			if (strcmp(tok, "update") == 0)
+				pc.update = atoi(val);
+			else if (strcmp(tok, "dist") == 0 && parse_dist(&pc, val))
+				;
+			else if (strcmp(tok, "offset") == 0)
+				offset = atoi(val);
+			else if (strcmp(tok, "threads") == 0)
+				pc.nb_threads = atoi(val);
+			else
+				goto bad;
+		}
+		if (pc.update < cfg->move + cfg->overwrite ||
+		    pc.update > 100 - cfg->snapshot - cfg->range_rate ||
+		    pc.nb_threads <= 0 || offset < 0 || offset >= 100 ||
+		    pc.theta <= 0 || pc.theta >= 1 || pc.hot_ops < 0 ||
+		    pc.hot_ops > 100 || pc.hot_keys <= 0 || pc.hot_keys > 100) {
+			printf("ERROR: %s:%d: settings out of range\n", cfg->phases, lineno);
+			exit(1);
+		}
+		p->update = pc.update;
+		p->nb_threads = pc.nb_threads;
+		p->offset = offset;
+		if (pc.dist == DIST_ZIPF || pc.dist == DIST_LATEST)
+			snprintf(p->dist_name, sizeof(p->dist_name), "%s:%.2f",
+				 dist_names[pc.dist], pc.theta);
+		else if (pc.dist == DIST_HOTSPOT)
+			snprintf(p->dist_name, sizeof(p->dist_name), "%s:%d:%d",
+				 dist_names[pc.dist], pc.hot_ops, pc.hot_keys);
+		else
+			snprintf(p->dist_name, sizeof(p->dist_name), "%s", dist_names[pc.dist]);
+		dist_init(&p->dist, &pc);
+		p->dist.shift = (long)((double)cfg->range * offset / 100.0);
+		if (cfg->nb_threads < p->nb_threads)
+			cfg->nb_threads = p->nb_threads;
+		duration += p->duration;
+		nb_phases++;
+	}
+	fclose(f);
+	if (nb_phases == 0) {
+		printf("ERROR: %s has no phase\n", cfg->phases);
+		exit(1);
+	}
+	if (duration > INT_MAX) {
+		printf("ERROR: %s lasts too long\n", cfg->phases);
+		exit(1);
+	}
+	cfg->duration = (int)duration;
+	return;
+ bad:
+	printf("ERROR: %s:%d: cannot parse %s\n", cfg->phases, lineno, tok);
+	exit(1);
+}
+
+/* Returns 1 if the option belongs to the structure and was stored */
+static int parse_option(const bench_ops_t *ops, int c, const char *arg)
+{
+	const bench_option_t *opt;
+
+	for (opt = ops->options; opt != NULL && opt->key != 0; opt++) {
+		if (opt->key == c) {
+			*opt->value = atoi(arg);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int bench_main(int argc, char **argv, const bench_ops_t *ops)
+{
+	struct option long_options[BENCH_MAX_OPTIONS] = {
+		// These options don't set a flag
+		{"help",                      no_argument,       NULL, 'h'},
+		{"alternate",                 no_argument,       NULL, 'A'},
+		{"growth",                    required_argument, NULL, 'g'},
+		{"effective",                 required_argument, NULL, 'f'},
+		{"duration",                  required_argument, NULL, 'd'},
+		{"initial-size",              required_argument, NULL, 'i'},
+		{"thread-num",                required_argument, NULL, 't'},
+		{"num-threads",               required_argument, NULL, 'n'},
+		{"range",                     required_argument, NULL, 'r'},
+		{"seed",                      required_argument, NULL, 'S'},
+		{"update-rate",               required_argument, NULL, 'u'},
+		{"elasticity",                required_argument, NULL, 'x'},
+		{"unbalance",                 required_argument, NULL, 'U'},
+		{"prefill",                   required_argument, NULL, 'F'},
+		{"prefill-sorted",            no_argument,       NULL, 'Y'},
+		{"bulk-build",                no_argument,       NULL, 'X'},
+		{"mono-int",                  no_argument,       NULL, 'm'},
+		{"reverse-int",               no_argument,       NULL, 'v'},
+		{"bias-range",                required_argument, NULL, 'b'},
+		{"bias-offset",               required_argument, NULL, 'B'},
+		{"latency",                   required_argument, NULL, 'L'},
+		{"distribution",              required_argument, NULL, 'D'},
+		{"key-buffer",                required_argument, NULL, 'K'},
+		{"pin",                       required_argument, NULL, 'P'},
+		{"pin-bg",                    required_argument, NULL, 'G'},
+		{"interval",                  required_argument, NULL, 'I'},
+		{"phases",                    required_argument, NULL, 'T'},
+		{"oversubscribe",             required_argument, NULL, 'M'},
+		{"preempt",                   required_argument, NULL, 'y'},
+		{"op-count",                  required_argument, NULL, 'N'},
+		{"rate",                      required_argument, NULL, 'Q'},
+		{"arrivals",                  required_argument, NULL, 'J'},
+		{"trace-record",              required_argument, NULL, 'W'},
+		{"trace-replay",              required_argument, NULL, 'R'},
+		{"check",                     no_argument,       NULL, 'C'},
+		{"perf",                      no_argument,       NULL, 'E'},
+		{"output",                    required_argument, NULL, 'o'},
+		{"output-file",               required_argument, NULL, 'O'},
+		{NULL, 0, NULL, 0}
+	};
+	char optstring[2 * BENCH_MAX_OPTIONS + sizeof(BENCH_OPTSTRING)];
+	const bench_option_t *opt;
+	const trace_stream_t *streams = NULL;
+	bench_config_t cfg;
+	void *set;
+	int i, j, c, nopts;
+	long size;
+	skey_t last = 0;
+	unsigned long reads, effreads, updates, effupds, moves, moved, snapshots,
+	snapshoted, ranges, ranged, range_keys, overwrites, overwritten,
+	value_errors, preempted, aborts, aborts_locked_read, aborts_locked_write,
+	aborts_validate_read, aborts_validate_write, aborts_validate_commit,
+	aborts_invalid_memory, aborts_double_write, max_retries,
+	failures_because_contention;
+	double secs;
+	thread_data_t *data;
+	pthread_t *threads;
+	pthread_attr_t attr;
+	barrier_t barrier;
+
+	cfg.duration = DEFAULT_DURATION;
+	cfg.initial = DEFAULT_INITIAL;
+	cfg.nb_threads = DEFAULT_NB_THREADS;
+	cfg.range = DEFAULT_RANGE;
+	cfg.seed = DEFAULT_SEED;
+	cfg.update = DEFAULT_UPDATE;
+	cfg.move = DEFAULT_MOVE;
+	cfg.snapshot = DEFAULT_SNAPSHOT;
+	cfg.range_rate = DEFAULT_RANGE_RATE;
+	cfg.range_len = DEFAULT_RANGE_LENGTH;
+	cfg.range_count = 0;
+	cfg.value_size = DEFAULT_VALUE_SIZE;
+	cfg.overwrite = DEFAULT_OVERWRITE;
+	cfg.unit_tx = (ops->unit_tx != 0 ? ops->unit_tx : DEFAULT_ELASTICITY);
+	cfg.alternate = DEFAULT_ALTERNATE;
+	cfg.growth = 0;
+	cfg.effective = DEFAULT_EFFECTIVE;
+	cfg.unbalanced = DEFAULT_UNBALANCED;
+	cfg.prefill = DEFAULT_PREFILL;
+	cfg.prefill_sorted = 0;
+	cfg.bulk = 0;
+	cfg.mono_int = 0;
+	cfg.reverse_int = 0;
+	cfg.bias_range = 0;
+	cfg.bias_offset = 0;
+	cfg.latency = DEFAULT_LATENCY;
+	cfg.dist = DIST_UNIFORM;
+	cfg.theta = DEFAULT_ZIPF_THETA;
+	cfg.hot_ops = DEFAULT_HOT_OPS;
+	cfg.hot_keys = DEFAULT_HOT_KEYS;
+	cfg.key_buffer = DEFAULT_KEY_BUFFER;
+	cfg.interval = DEFAULT_INTERVAL;
+	cfg.op_count = DEFAULT_OP_COUNT;
+	cfg.rate = DEFAULT_RATE;
+	cfg.arrivals = ARRIVAL_POISSON;
+	cfg.trace_out = NULL;
+	cfg.trace_in = NULL;
+	cfg.phases = NULL;
+	cfg.oversub = 0;
+	cfg.preempt = 0;
+	cfg.preempt_us = 0;
+	cfg.check = 0;
+	cfg.perf = 0;
+	cfg.output = OUT_NONE;
+	cfg.output_file = NULL;
+	cfg.pin = PIN_NONE;
+	cfg.pin_cpus = NULL;
+	cfg.pin_bg = NULL;
+
+	/* Append move/snapshot/range/map and structure-specific options */
+	strcpy(optstring, BENCH_OPTSTRING);
+	for (nopts = 0; long_options[nopts].name != NULL; nopts++)
+		;
+	if (ops->move != NULL) {
+		strcat(optstring, "a:");
+		long_options[nopts].name = "move-rate";
+		long_options[nopts].has_arg = required_argument;
+		long_options[nopts].val = 'a';
+		nopts++;
+	}
+	if (ops->snapshot != NULL) {
+		strcat(optstring, "s:");
+		long_options[nopts].name = "snapshot-rate";
+		long_options[nopts].has_arg = required_argument;
+		long_options[nopts].val = 's';
+		nopts++;
+	}
+	if (ops->range != NULL) {
+		strcat(optstring, "q:w:k");
+		long_options[nopts].name = "range-rate";
+		long_options[nopts].has_arg = required_argument;
+		long_options[nopts].val = 'q';
+		nopts++;
+		long_options[nopts].name = "range-length";
+		long_options[nopts].has_arg = required_argument;
+		long_options[nopts].val = 'w';
+		nopts++;
+		long_options[nopts].name = "range-count";
+		long_options[nopts].has_arg = no_argument;
+		long_options[nopts].val = 'k';
+		nopts++;
+	}
+	if (ops->get != NULL) {
+		strcat(optstring, "V:e:");
+		long_options[nopts].name = "value-size";
+		long_options[nopts].has_arg = required_argument;
+		long_options[nopts].val = 'V';
+		nopts++;
+		long_options[nopts].name = "overwrite-rate";
+		long_options[nopts].has_arg = required_argument;
+		long_options[nopts].val = 'e';
+		nopts++;
+	}
+	for (opt = ops->options; opt != NULL && opt->key != 0; opt++) {
+		assert(nopts < BENCH_MAX_OPTIONS - 1);
+		i = strlen(optstring);
+		optstring[i] = (char)opt->key;
+		optstring[i + 1] = ':';
+		optstring[i + 2] = '\0';
+		long_options[nopts].name = opt->name;
+		long_options[nopts].has_arg = required_argument;
+		long_options[nopts].val = opt->key;
+		nopts++;
+	}
+	memset(&long_options[nopts], 0, sizeof(struct option));
+
+	while(1) {
+		i = 0;
+		c = getopt_long(argc, argv, optstring, long_options, &i);
+
+		if(c == -1)
+			break;
+
+		if(c == 0 && long_options[i].flag == 0)
+			c = long_options[i].val;
+
+		switch(c) {
+		case 0:
+			/* Flag is automatically set */
+			break;
+		case 'h':
+			usage(ops);
+			exit(0);
+		case 'A':
+			cfg.alternate = 1;
+			break;
+		case 'g':
+			cfg.growth = atoi(optarg);
+			break;
+		case 'f':
+			cfg.effective = atoi(optarg);
+			break;
+		case 'd':
+			cfg.duration = atoi(optarg);
+			break;
+		case 'i':
+			cfg.initial = atoi(optarg);
+			break;
+		case 't':
+		case 'n':
+			cfg.nb_threads = atoi(optarg);
+			break;
+		case 'r':
+			cfg.range = atol(optarg);
+			break;
+		case 'S':
+			cfg.seed = atoi(optarg);
+			break;
+		case 'u':
+			cfg.update = atoi(optarg);
+			break;
+		case 'a':
+			cfg.move = atoi(optarg);
+			break;
+		case 's':
+			cfg.snapshot = atoi(optarg);
+			break;
+		case 'q':
+			cfg.range_rate = atoi(optarg);
+			break;
+		case 'w':
+			cfg.range_len = atol(optarg);
+			break;
+		case 'k':
+			cfg.range_count = 1;
+			break;
+		case 'V':
+			cfg.value_size = atoi(optarg);
+			break;
+		case 'e':
+			cfg.overwrite = atoi(optarg);
+			break;
+		case 'x':
+			cfg.unit_tx = atoi(optarg);
+			break;
+		case 'U':
+			cfg.unbalanced = atoi(optarg);
+			break;
+		case 'F':
+			cfg.prefill = atoi(optarg);
+			break;
+		case 'Y':
+			cfg.prefill_sorted = 1;
+			break;
+		case 'X':
+			if (ops->bulk_build != NULL) {
+				cfg.bulk = 1;
+				break;
+			}
+			printf("ERROR: %s cannot be bulk-built\n", ops->name);
+			exit(1);
+		case 'm':
+			cfg.mono_int = 1;
+			break;
+		case 'v':
+			cfg.reverse_int = 1;
+			break;
+		case 'b':
+			cfg.bias_range = atol(optarg);
+			break;
+		case 'B':
+			cfg.bias_offset = atol(optarg);
+			break;
+		case 'L':
+			cfg.latency = atoi(optarg);
+			break;
+		case 'K':
+			cfg.key_buffer = atol(optarg);
+			break;
+		case 'E':
+			cfg.perf = 1;
+			break;
+		case 'o':
+			if (parse_output(&cfg, optarg))
+				break;
+			printf("ERROR: Unknown output format %s\n", optarg);
+			exit(1);
+		case 'O':
+			cfg.output_file = optarg;
+			break;
+		case 'W':
+			cfg.trace_out = optarg;
+			break;
+		case 'C':
+			cfg.check = 1;
+			break;
+		case 'R':
+			cfg.trace_in = optarg;
+			break;
+		case 'N':
+			cfg.op_count = atol(optarg);
+			break;
+		case 'I':
+			cfg.interval = atoi(optarg);
+			break;
+		case 'T':
+			cfg.phases = optarg;
+			break;
+		case 'M':
+			cfg.oversub = atoi(optarg);
+			break;
+		case 'y':
+			if (sscanf(optarg, "%d:%d", &cfg.preempt, &cfg.preempt_us) >= 1)
+				break;
+			printf("ERROR: Invalid preemption %s\n", optarg);
+			exit(1);
+		case 'Q':
+			cfg.rate = atol(optarg);
+			break;
+		case 'J':
+			for (j = 0; j < (int)(sizeof(arrival_names) / sizeof(arrival_names[0])); j++)
+				if (strcmp(optarg, arrival_names[j]) == 0)
+					break;
+			if (j < (int)(sizeof(arrival_names) / sizeof(arrival_names[0]))) {
+				cfg.arrivals = j;
+				break;
+			}
+			printf("ERROR: Unknown arrival process %s\n", optarg);
+			exit(1);
+		case 'P':
+			parse_pin(&cfg, optarg);
+			break;
+		case 'G':
+			cfg.pin_bg = optarg;
+			break;
+		case 'D':
+			if (parse_dist(&cfg, optarg))
+				break;
+			printf("ERROR: Unknown key distribution or invalid parameters %s\n", optarg);
+			exit(1);
+		case '?':
+			printf("Use -h or --help for help\n");
+			exit(0);
+		default:
+			if (parse_option(ops, c, optarg))
+				break;
+			exit(1);
+		}
+	}
+
+	if (cfg.mono_int && cfg.reverse_int) {
+		printf("ERROR: Can only choose one from -v and -m\n");
+		exit(1);
+	}
+	if (cfg.trace_in != NULL && (cfg.trace_out != NULL || cfg.op_count > 0)) {
+		printf("ERROR: -R cannot be combined with -W or -N\n");
+		exit(1);
+	}
+	if (cfg.bulk && cfg.prefill > 0) {
+		printf("ERROR: -X cannot be combined with -F\n");
+		exit(1);
+	}
+#ifdef SEQUENTIAL
+	if (cfg.prefill > 1) {
+		printf("ERROR: Sequential sets cannot be populated from several threads (-F)\n");
+		exit(1);
+	}
+#endif
+	fixed_ops = (cfg.op_count > 0 || cfg.trace_in != NULL);
+	/* Tail latency tells blocking and non-blocking designs apart */
+	if ((cfg.rate > 0 || cfg.oversub > 0 || cfg.preempt > 0) && cfg.latency == 0)
+		cfg.latency = 1;
+	if (cfg.oversub > 0)
+		cfg.nb_threads = cfg.oversub * online_cpus();
+
+	check_arg(cfg.duration >= 0, "duration (-d)");
+	check_arg(cfg.initial >= 0, "initial size (-i)");
+	assert(cfg.prefill >= 0);
+	check_arg(cfg.nb_threads > 0, "number of threads (-t)");
+	check_arg(cfg.range > 0 && cfg.range >= cfg.initial,
+		  "range (-r), it must be positive and hold the initial size (-i)");
+	check_arg(cfg.update >= 0 && cfg.update <= 100, "update rate (-u)");
+	check_arg(cfg.move >= 0 && cfg.move <= cfg.update,
+		  "move rate (-a), it must be within the update rate (-u)");
+	check_arg(cfg.snapshot >= 0 && cfg.snapshot <= (100 - cfg.update),
+		  "snapshot rate (-s), it must leave room for the update rate (-u)");
+	assert(cfg.range_rate >= 0 && cfg.range_rate <= (100 - cfg.update - cfg.snapshot));
+	assert(cfg.range_len > 0);
+	check_arg(cfg.value_size >= 0 && cfg.value_size <= MAX_VALUE_SIZE &&
+		  cfg.value_size % sizeof(uint64_t) == 0,
+		  "value size (-V), it must be a multiple of 8 up to " XSTR(MAX_VALUE_SIZE));
+	check_arg(cfg.overwrite >= 0 && cfg.overwrite <= (cfg.update - cfg.move),
+		  "overwrite rate (-e), it must be within the updates that are not moves");
+	assert(cfg.growth >= 0 && cfg.growth <= 100);
+	if (cfg.overwrite > 0 && cfg.value_size == 0) {
+		printf("ERROR: Overwrites (-e) need map mode (-V)\n");
+		exit(1);
+	}
+	if (cfg.bulk && cfg.value_size > 0) {
+		printf("ERROR: Bulk build (-X) does not store values, use map mode (-V) without it\n");
+		exit(1);
+	}
+	if (cfg.bias_range != 0 || cfg.bias_offset != 0)
+		check_arg(cfg.bias_range > 0 && cfg.bias_offset > 0,
+			  "bias (-b, -B), both must be positive");
+	assert(cfg.latency >= 0);
+	assert(cfg.key_buffer >= 0);
+	assert(cfg.interval >= 0);
+	assert(cfg.op_count >= 0);
+	assert(cfg.rate >= 0);
+	assert(cfg.oversub >= 0);
+	assert(cfg.preempt >= 0 && cfg.preempt_us >= 0);
+	bench_preempt_every = cfg.preempt;
+	preempt_us = cfg.preempt_us;
+	if (cfg.phases != NULL) {
+		if (fixed_ops || cfg.key_buffer > 0 || cfg.bias_range > 0) {
+			printf("ERROR: -T cannot be combined with -N, -R, -K or -b\n");
+			exit(1);
+		}
+		phases_load(&cfg);
+	}
+
+	printf("Set type     : %s\n", ops->name);
+	if (cfg.trace_in != NULL)
+		printf("Trace replay : %s\n", cfg.trace_in);
+	else if (cfg.op_count > 0)
+		printf("Op count     : %ld per thread\n", cfg.op_count);
+	else
+		printf("Duration     : %d\n", cfg.duration);
+	if (cfg.phases != NULL)
+		printf("Phases       : %d from %s\n", nb_phases, cfg.phases);
+	if (cfg.trace_out != NULL)
+		printf("Trace record : %s\n", cfg.trace_out);
+	if (cfg.check)
+		printf("Check        : linearizability\n");
+	printf("Initial size : %d\n", cfg.initial);
+	printf("Nb threads   : %d\n", cfg.nb_threads);
+	if (cfg.oversub > 0)
+		printf("Oversubscribe: %d threads per CPU, %d CPUs\n", cfg.oversub,
+		       cfg.nb_threads / cfg.oversub);
+	if (cfg.preempt > 0 && cfg.preempt_us > 0)
+		printf("Preemption   : 1 lock holder in %d sleeps %d us\n", cfg.preempt,
+		       cfg.preempt_us);
+	else if (cfg.preempt > 0)
+		printf("Preemption   : 1 lock holder in %d yields\n", cfg.preempt);
+	printf("Value range  : %ld\n", cfg.range);
+	/* Resolved now so that the run can be reproduced */
+	if (cfg.seed == 0)
+		cfg.seed = (int)time(0);
+	printf("Seed         : %d\n", cfg.seed);
+	printf("Update rate  : %d\n", cfg.update);
+	if (ops->move != NULL)
+		printf("Move rate    : %d\n", cfg.move);
+	if (ops->snapshot != NULL)
+		printf("Snapshot rate: %d\n", cfg.snapshot);
+	if (ops->range != NULL) {
+		printf("Range rate   : %d\n", cfg.range_rate);
+		printf("Range length : %ld\n", cfg.range_len);
+		printf("Range scans  : %s, %s\n", cfg.range_count ? "count" : "collect",
+		       ops->range_linearizable ? "linearizable" : "weakly consistent");
+	}
+	if (cfg.value_size > 0) {
+		printf("Value size   : %d (map)\n", cfg.value_size);
+		printf("Overwrite    : %d\n", cfg.overwrite);
+	}
+	printf("Elasticity   : %d\n", cfg.unit_tx);
+	printf("Alternate    : %d\n", cfg.alternate);
+	if (cfg.growth > 0)
+		printf("Growth       : %d\n", cfg.growth);
+	printf("Effective    : %d\n", cfg.effective);
+	printf("Unbalanced   : %d\n", cfg.unbalanced);
+	if (cfg.bulk)
+		printf("Prefill      : bulk build\n");
+	else if (cfg.prefill > 0 || cfg.prefill_sorted)
+		printf("Prefill      : %d threads%s\n", cfg.prefill,
+		       cfg.prefill_sorted ? ", sorted" : "");
+	printf("Mono int     : %d\n", cfg.mono_int);
+	printf("Reverse int  : %d\n", cfg.reverse_int);
+	if (cfg.bias_range > 0)
+		printf("Biased range : [%ld, %ld)\n", cfg.bias_offset,
+		       cfg.bias_offset + cfg.bias_range);
+	printf("Distribution : %s", dist_names[cfg.dist]);
+	if (cfg.dist == DIST_ZIPF || cfg.dist == DIST_LATEST)
+		printf(" (theta %.2f)", cfg.theta);
+	else if (cfg.dist == DIST_HOTSPOT)
+		printf(" (%d%% of ops on %d%% of keys)", cfg.hot_ops, cfg.hot_keys);
+	printf("\n");
+	if (cfg.key_buffer > 0)
+		printf("Key buffer   : %ld\n", cfg.key_buffer);
+	if (cfg.rate > 0)
+		printf("Open loop    : %ld ops/s per thread, %s arrivals\n",
+		       cfg.rate, arrival_names[cfg.arrivals]);
+	if (cfg.latency > 0)
+		printf("Latency      : 1 op in %d\n", cfg.latency);
+	pin_init(&cfg);
+	print_pinning(&cfg);
+	for (opt = ops->options; opt != NULL && opt->key != 0; opt++)
+		printf("%-13s: %d\n", opt->name, *opt->value);
+	printf("Type sizes   : int=%d/long=%d/ptr=%d/word=%d\n",
+	       (int)sizeof(int),
+	       (int)sizeof(long),
+	       (int)sizeof(void *),
+	       (int)sizeof(uintptr_t));
+
+	/* Keep each thread's counters on their own cache lines */
+	if (posix_memalign((void **)&data, 64, cfg.nb_threads * sizeof(thread_data_t)) != 0) {
+		perror("malloc");
+		exit(1);
+	}
+	if ((threads = (pthread_t *)malloc(cfg.nb_threads * sizeof(pthread_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+
+	srand(cfg.seed);
+
+	dist_init(&dist, &cfg);
+	if (cfg.trace_in != NULL) {
+		streams = trace_open(cfg.trace_in, ops, &cfg);
+		printf("Trace streams: %lu\n",
+		       (unsigned long)((const trace_header_t *)trace_map)->nb_streams);
+	}
+
+	mem_read(&mem_base);
+	set = ops->init(&cfg);
+	stop = 0;
+
+	/* Populate set */
+	printf("Adding %d entries to set\n", cfg.initial);
+	last = populate(set, &cfg, ops);
+	size = ops->size(set);
+	printf("Prefill time : %.3f ms\n", prefill_ns / 1e6);
+	printf("Set size     : %ld\n", size);
+	if (size != cfg.initial)
+		printf("ERROR: Set size does not match the initial size.\n");
+
+	if (ops->populated != NULL)
+		ops->populated(set, &cfg);
+	mem_read(&mem_populated);
+	mem_peak = mem_populated;
+	populated_size = size;
+
+	/* Access set from all threads */
+	barrier_init(&barrier, cfg.nb_threads + 1);
+	nb_running = cfg.nb_threads;
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+	for (i = 0; i < cfg.nb_threads; i++) {
+		printf("Creating thread %d\n", i);
+		thread_data_init(&data[i], i, &cfg, ops, set, &barrier);
+		data[i].first = last;
+		if (cfg.latency > 0)
+			data[i].lat = lat_alloc(&data[i]);
+		if (cfg.perf)
+			data[i].perf = perf_alloc();
+		if (streams != NULL) {
+			j = i % ((const trace_header_t *)trace_map)->nb_streams;
+			data[i].replay = (const uint64_t *)((const char *)trace_map + streams[j].offset);
+			data[i].replay_len = streams[j].nb_records;
+		}
+		if (cfg.trace_out != NULL) {
+			data[i].trace_cap = 1 << 16;
+			if ((data[i].trace = (uint64_t *)malloc(data[i].trace_cap * sizeof(uint64_t))) == NULL) {
+				perror("malloc");
+				exit(1);
+			}
+		}
+		if (cfg.check) {
+			data[i].history_cap = (cfg.op_count > 0 ? cfg.op_count : 1 << 16);
+			if ((data[i].history = (bench_event_t *)malloc(data[i].history_cap * sizeof(bench_event_t))) == NULL) {
+				perror("malloc");
+				exit(1);
+			}
+		}
+		if (pthread_create(&threads[i], &attr, test, (void *)(&data[i])) != 0) {
+			fprintf(stderr, "Error creating thread\n");
+			exit(1);
+		}
+	}
+	pthread_attr_destroy(&attr);
+
+	/* Catch some signals */
+	if (signal(SIGHUP, catcher) == SIG_ERR ||
+	    signal(SIGTERM, catcher) == SIG_ERR) {
+		perror("signal");
+		exit(1);
+	}
+
+	/* Start threads */
+	barrier_cross(&barrier);
+
+	printf("STARTING...\n");
+	if (cfg.interval > 0)
+		sample_run(data, &cfg);
+	else
+		wait_run(data, &cfg);
+	AO_store_full(&stop, 1);
+	printf("STOPPING...\n");
+
+	/* Wait for thread completion */
+	for (i = 0; i < cfg.nb_threads; i++) {
+		if (pthread_join(threads[i], NULL) != 0) {
+			fprintf(stderr, "Error waiting for thread completion\n");
+			exit(1);
+		}
+	}
+
+	if (ops->finish != NULL)
+		ops->finish(set);
+	mem_sample();
+	mem_read(&mem_end);
+	if (ops->memory != NULL)
+		ops->memory(set, data, cfg.nb_threads, &set_mem);
+	if (cfg.trace_out != NULL)
+		trace_write(cfg.trace_out, data, &cfg);
+
+	/* Rates are over the workers' window, not the main thread's sleep */
+	cfg.elapsed_ns = run_window(data, cfg.nb_threads);
+	if (cfg.elapsed_ns == 0)
+		cfg.elapsed_ns = 1;
+	secs = cfg.elapsed_ns / 1e9;
+	aborts = 0;
+	aborts_locked_read = 0;
+	aborts_locked_write = 0;
+	aborts_validate_read = 0;
+	aborts_validate_write = 0;
+	aborts_validate_commit = 0;
+	aborts_invalid_memory = 0;
+	aborts_double_write = 0;
+	failures_because_contention = 0;
+	reads = 0;
+	effreads = 0;
+	updates = 0;
+	effupds = 0;
+	moves = 0;
+	moved = 0;
+	snapshots = 0;
+	snapshoted = 0;
+	ranges = 0;
+	ranged = 0;
+	range_keys = 0;
+	overwrites = 0;
+	overwritten = 0;
+	value_errors = 0;
+	preempted = 0;
+	max_retries = 0;
+	for (i = 0; i < cfg.nb_threads; i++) {
+		printf("Thread %d\n", i);
+		printf("  #add        : %lu\n", data[i].nb_add);
+		printf("    #added    : %lu\n", data[i].nb_added);
+		printf("  #remove     : %lu\n", data[i].nb_remove);
+		printf("    #removed  : %lu\n", data[i].nb_removed);
+		printf("  #contains   : %lu\n", data[i].nb_contains);
+		printf("    #found    : %lu\n", data[i].nb_found);
+		if (ops->move != NULL) {
+			printf("  #move       : %lu\n", data[i].nb_move);
+			printf("    #moved    : %lu\n", data[i].nb_moved);
+		}
+		if (ops->snapshot != NULL) {
+			printf("  #snapshot   : %lu\n", data[i].nb_snapshot);
+			printf("    #snapshoted: %lu\n", data[i].nb_snapshoted);
+		}
+		if (ops->range != NULL) {
+			printf("  #range      : %lu\n", data[i].nb_range);
+			printf("    #ranged   : %lu\n", data[i].nb_ranged);
+			printf("    #keys     : %lu\n", data[i].nb_range_keys);
+		}
+		if (cfg.value_size > 0) {
+			printf("  #overwrite  : %lu\n", data[i].nb_overwrite);
+			printf("    #replaced : %lu\n", data[i].nb_overwritten);
+		}
+		printf("  #aborts     : %lu\n", data[i].nb_aborts);
+		printf("    #lock-r   : %lu\n", data[i].nb_aborts_locked_read);
+		printf("    #lock-w   : %lu\n", data[i].nb_aborts_locked_write);
+		printf("    #val-r    : %lu\n", data[i].nb_aborts_validate_read);
+		printf("    #val-w    : %lu\n", data[i].nb_aborts_validate_write);
+		printf("    #val-c    : %lu\n", data[i].nb_aborts_validate_commit);
+		printf("    #inv-mem  : %lu\n", data[i].nb_aborts_invalid_memory);
+		printf("    #dup-w    : %lu\n", data[i].nb_aborts_double_write);
+		printf("    #failures : %lu\n", data[i].failures_because_contention);
+		printf("  Max retries : %lu\n", data[i].max_retries);
+		if (cfg.preempt > 0)
+			printf("  #preempted  : %lu\n", data[i].nb_preempted);
+		aborts += data[i].nb_aborts;
+		aborts_locked_read += data[i].nb_aborts_locked_read;
+		aborts_locked_write += data[i].nb_aborts_locked_write;
+		aborts_validate_read += data[i].nb_aborts_validate_read;
+		aborts_validate_write += data[i].nb_aborts_validate_write;
+		aborts_validate_commit += data[i].nb_aborts_validate_commit;
+		aborts_invalid_memory += data[i].nb_aborts_invalid_memory;
+		aborts_double_write += data[i].nb_aborts_double_write;
+		failures_because_contention += data[i].failures_because_contention;
+		reads += data[i].nb_contains;
+		effreads += data[i].nb_contains +
+			(data[i].nb_add - data[i].nb_added) +
+			(data[i].nb_remove - data[i].nb_removed) +
+			(data[i].nb_move - data[i].nb_moved) +
+			(data[i].nb_overwrite - data[i].nb_overwritten) +
+			data[i].nb_snapshoted + data[i].nb_range;
+		updates += (data[i].nb_add + data[i].nb_remove + data[i].nb_move +
+			    data[i].nb_overwrite);
+		effupds += data[i].nb_removed + data[i].nb_added + data[i].nb_moved +
+			data[i].nb_overwritten;
+		moves += data[i].nb_move;
+		moved += data[i].nb_moved;
+		snapshots += data[i].nb_snapshot;
+		snapshoted += data[i].nb_snapshoted;
+		ranges += data[i].nb_range;
+		ranged += data[i].nb_ranged;
+		range_keys += data[i].nb_range_keys;
+		overwrites += data[i].nb_overwrite;
+		overwritten += data[i].nb_overwritten;
+		value_errors += data[i].nb_value_errors;
+		preempted += data[i].nb_preempted;
+		size += data[i].nb_added - data[i].nb_removed;
+		if (max_retries < data[i].max_retries)
+			max_retries = data[i].max_retries;
+	}
+	printf("Set size      : %ld (expected: %ld)\n", ops->size(set), size);
+	if (ops->size(set) != size)
+		printf("ERROR: Set size did not match expected.\n");
+	printf("Duration      : %.3f (ms)\n", cfg.elapsed_ns / 1e6);
+	print_completion(data, &cfg);
+	if (cfg.rate > 0)
+		print_schedule(data, &cfg);
+	printf("#txs          : %lu (%f / s)\n", reads + updates + snapshots + ranges,
+	       (reads + updates + snapshots + ranges) / secs);
+
+	printf("#read txs     : ");
+	if (cfg.effective) {
+		printf("%lu (%f / s)\n", effreads, effreads / secs);
+		printf("  #contains   : %lu (%f / s)\n", reads, reads / secs);
+	} else printf("%lu (%f / s)\n", reads, reads / secs);
+
+	printf("#eff. upd rate: %f \n", 100.0 * effupds / (effupds + effreads));
+
+	printf("#update txs   : ");
+	if (cfg.effective) {
+		printf("%lu (%f / s)\n", effupds, effupds / secs);
+		printf("  #upd trials : %lu (%f / s)\n", updates, updates / secs);
+	} else printf("%lu (%f / s)\n", updates, updates / secs);
+
+	if (ops->move != NULL) {
+		printf("#move txs     : %lu (%f / s)\n", moves, moves / secs);
+		printf("  #moved      : %lu (%f / s)\n", moved, moved / secs);
+	}
+	if (ops->snapshot != NULL) {
+		printf("#snapshot txs : %lu (%f / s)\n", snapshots, snapshots / secs);
+		printf("  #snapshoted : %lu (%f / s)\n", snapshoted, snapshoted / secs);
+	}
+	if (ops->range != NULL) {
+		printf("#range txs    : %lu (%f / s)\n", ranges, ranges / secs);
+		printf("  #ranged     : %lu (%f / s)\n", ranged, ranged / secs);
+		printf("  #keys       : %lu (%.2f per range)\n", range_keys,
+		       ranges > 0 ? (double)range_keys / ranges : 0.0);
+	}
+	if (cfg.value_size > 0) {
+		printf("#overwrite txs: %lu (%f / s)\n", overwrites, overwrites / secs);
+		printf("  #replaced   : %lu (%f / s)\n", overwritten, overwritten / secs);
+		printf("#value errors : %lu\n", value_errors);
+		if (value_errors > 0)
+			printf("ERROR: Values got did not match the ones put.\n");
+	}
+	printf("#aborts       : %lu (%f / s)\n", aborts, aborts / secs);
+	printf("  #lock-r     : %lu (%f / s)\n", aborts_locked_read, aborts_locked_read / secs);
+	printf("  #lock-w     : %lu (%f / s)\n", aborts_locked_write, aborts_locked_write / secs);
+	printf("  #val-r      : %lu (%f / s)\n", aborts_validate_read, aborts_validate_read / secs);
+	printf("  #val-w      : %lu (%f / s)\n", aborts_validate_write, aborts_validate_write / secs);
+	printf("  #val-c      : %lu (%f / s)\n", aborts_validate_commit, aborts_validate_commit / secs);
+	printf("  #inv-mem    : %lu (%f / s)\n", aborts_invalid_memory, aborts_invalid_memory / secs);
+	printf("  #dup-w      : %lu (%f / s)\n", aborts_double_write, aborts_double_write / secs);
+	printf("  #failures   : %lu\n",  failures_because_contention);
+	printf("Max retries   : %lu\n", max_retries);
+	if (cfg.preempt > 0) {
+		printf("#preemptions  : %lu\n", preempted);
+		if (preempted == 0)
+			printf("  (%s takes no lock the driver sees)\n", ops->name);
+	}
+
+	if (nb_phases > 0)
+		print_phases(&cfg);
+	if (cfg.latency > 0)
+		print_latency(data, &cfg);
+	if (cfg.perf)
+		print_perf(data, &cfg, reads + updates + snapshots + ranges);
+	print_memory(ops, ops->size(set));
+	if (cfg.check)
+		check_history(set, ops, &cfg, data);
+	if (cfg.output != OUT_NONE)
+		print_record(argv[0], ops, &cfg, data, ops->size(set), size);
+
+	/* Delete set */
+	ops->destroy(set);
+	bulk_free();
+
+	for (i = 0; i < cfg.nb_threads; i++) {
+		free(data[i].lat);
+		free(data[i].keys);
+		free(data[i].range_keys);
+		free(data[i].value);
+		free(data[i].perf);
+		free(data[i].trace);
+		free(data[i].history);
+	}
+	if (trace_map != NULL)
+		munmap(trace_map, trace_size);
+	free(phases);
+	free(phase_lat);
+	free(threads);
+	free(data);
+
+	return (check_failed > 0);
+}
@@ -0,0 +1,380 @@
+/*
+ * File:
+ *   bench.h
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Benchmark driver shared by all data structures. Each structure
+ *   provides a bench_ops_t table and calls bench_main() from its test.c,
+ *   the driver takes care of option parsing, population, thread
+ *   management, the workload loop and statistics.
+ *
+ * Copyright (c) 2026.
+ *
+ * bench.h is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic_ops.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Keys handed to the set operations, always in [1; range] */
+typedef intptr_t skey_t;
+
+typedef struct barrier {
+	volatile AO_t count;	/* threads yet to arrive */
+	volatile AO_t sense;	/* flipped by the last one */
+	int n;
+} barrier_t;
+
+void barrier_init(barrier_t *b, int n);
+void barrier_cross(barrier_t *b);
+
+/* Key distributions of the operations (-D) */
+enum {
+	DIST_UNIFORM,
+	DIST_ZIPF,
+	DIST_HOTSPOT,
+	DIST_SEQUENTIAL,
+	DIST_LATEST
+};
+
+/*
+ * Operation traces (-W records one, -R replays it), in host byte order:
+ * a trace_header_t, then nb_streams trace_stream_t, then the records of
+ * each stream. A record is one word, trace_op() | trace_ok() | key with
+ * key < 2^56. A move takes two records, the removed key then the added
+ * one, and so does a range query, its lowest key then its highest.
+ * Streams are replayed one per thread, thread i taking stream i %
+ * nb_streams.
+ */
+#define TRACE_MAGIC             "SBTRACE"
+#define TRACE_VERSION           1
+#define TRACE_KEY_MASK          ((UINT64_C(1) << 56) - 1)
+#define TRACE_OP_SHIFT          56
+#define TRACE_OK                (UINT64_C(1) << 63)
+#define trace_op(w)             ((int)(((w) >> TRACE_OP_SHIFT) & 0xF))
+
+/* Operation codes of the trace records */
+enum {
+	TRACE_ADD,
+	TRACE_REMOVE,
+	TRACE_CONTAINS,
+	TRACE_MOVE,
+	TRACE_SNAPSHOT,
+	TRACE_RANGE,
+	TRACE_OVERWRITE
+};
+
+typedef struct trace_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t flags;		/* none defined yet, 0 */
+	uint64_t nb_streams;
+	uint64_t range;		/* of the recording run, informative */
+} trace_header_t;
+
+typedef struct trace_stream {
+	uint64_t offset;	/* of the first record, in bytes from the start */
+	uint64_t nb_records;
+} trace_stream_t;
+
+/* Run parameters, as parsed from the command line */
+typedef struct bench_config {
+	int duration;
+	int initial;
+	int nb_threads;
+	long range;
+	int seed;
+	int update;
+	int move;
+	int snapshot;
+	int range_rate;		/* % of range queries */
+	long range_len;		/* keys spanned by a range query */
+	int range_count;	/* count the keys rather than collect them */
+	int value_size;		/* map mode: bytes per value, 0 for a set */
+	int overwrite;		/* map mode: % of value overwrites */
+	int unit_tx;
+	int alternate;
+	int growth;		/* % of adds that follow a successful add */
+	int effective;
+	int unbalanced;
+	int prefill;		/* populating threads, 0 for the main thread */
+	int prefill_sorted;	/* populate in increasing key order */
+	int bulk;		/* populate with bulk_build */
+	int mono_int;
+	int reverse_int;
+	long bias_range;
+	long bias_offset;
+	int latency;		/* time 1 op in <latency>, 0 disables */
+	int dist;
+	double theta;		/* zipf and latest skew */
+	int hot_ops;		/* hotspot: % of ops on hot_keys % of keys */
+	int hot_keys;
+	long key_buffer;	/* pre-generated keys per thread, 0 disables */
+	int interval;		/* time series period in ms, 0 disables */
+	long op_count;		/* operations per thread, 0 for a timed run */
+	long rate;		/* open loop: ops/s per thread, 0 for closed */
+	int arrivals;		/* open loop arrival process */
+	int perf;		/* count hardware events */
+	int output;		/* result record format */
+	const char *output_file;	/* NULL for stdout */
+	const char *trace_out;	/* trace to record, NULL if none */
+	const char *trace_in;	/* trace to replay, NULL if none */
+	const char *phases;	/* workload script, NULL for a steady run */
+	int oversub;		/* threads per CPU, 0 to take nb_threads */
+	int preempt;		/* deschedule lock holders 1 time in <preempt> */
+	int preempt_us;		/* sleep that long, 0 to yield */
+	int check;		/* log the history and check it is linearizable */
+	int pin;		/* worker placement policy */
+	const char *pin_cpus;	/* worker CPU list, explicit policy */
+	const char *pin_bg;	/* background CPU list, NULL for default */
+	uint64_t elapsed_ns;	/* workers' window, once the run is over */
+} bench_config_t;
+
+struct bench_ops;
+struct bench_hist;
+struct bench_perf;
+struct bench_event;
+struct key_dist;
+
+/* State of the per-thread pseudo-random generator */
+typedef struct bench_rng {
+	uint64_t s[2];
+} bench_rng_t;
+
+/*
+ * Per-thread state. The populating (main) thread also gets one, with
+ * unit_tx forced to 0 as the set is not accessed concurrently then.
+ * The counter names are the ones TM_THREAD_EXIT() fills in.
+ */
+typedef struct thread_data {
+	int id;
+	skey_t first;
+	long range;
+	int update;
+	int move;
+	int snapshot;
+	int range_rate;
+	long range_len;
+	int overwrite;
+	int unit_tx;
+	int alternate;
+	int growth;
+	int effective;
+	long bias_range;
+	long bias_offset;
+	unsigned long seq;	/* next increasing key, sequential/latest */
+	long seq_stride;
+	const struct key_dist *dist;	/* of the phase being run */
+	unsigned long phase;	/* of the workload script (-T) */
+	unsigned long phase_tx;	/* ops and effective updates before it */
+	unsigned long phase_upd;
+	unsigned long nb_add;
+	unsigned long nb_added;
+	unsigned long nb_remove;
+	unsigned long nb_removed;
+	unsigned long nb_contains;
+	unsigned long nb_found;
+	unsigned long nb_move;
+	unsigned long nb_moved;
+	unsigned long nb_snapshot;
+	unsigned long nb_snapshoted;
+	unsigned long nb_range;
+	unsigned long nb_ranged;	/* range queries that found keys */
+	unsigned long nb_range_keys;
+	unsigned long nb_overwrite;
+	unsigned long nb_overwritten;
+	unsigned long nb_value_errors;	/* values got that were not put */
+	unsigned long nb_aborts;
+	unsigned long nb_aborts_locked_read;
+	unsigned long nb_aborts_locked_write;
+	unsigned long nb_aborts_validate_read;
+	unsigned long nb_aborts_validate_write;
+	unsigned long nb_aborts_validate_commit;
+	unsigned long nb_aborts_invalid_memory;
+	unsigned long nb_aborts_double_write;
+	unsigned long max_retries;
+	unsigned long failures_because_contention;
+	unsigned long nb_preempted;	/* lock holders descheduled (-y) */
+	int preempt_countdown;
+	bench_rng_t rng;
+	skey_t *keys;		/* pre-generated keys (-K), NULL if disabled */
+	long nb_keys;
+	long key_next;
+	skey_t *range_keys;	/* keys of a range query, NULL to count them */
+	long range_cap;
+	uint64_t *value;	/* map mode: value put or got, NULL for a set */
+	long value_words;
+	unsigned long value_version;
+	unsigned long op_count;	/* operations to run, 0 until stopped */
+	uint64_t start_ns;	/* when the thread left the start barrier */
+	uint64_t elapsed_ns;	/* time to complete the timed loop */
+	double gap_ns;		/* open loop: mean time between ops, 0 if closed */
+	int arrivals;
+	uint64_t next_ns;	/* when the next op is due */
+	uint64_t intended;	/* when the current op was due, 0 if closed */
+	uint64_t behind_ns;	/* lag on the schedule at the end of the run */
+	const uint64_t *replay;	/* stream to replay (-R), NULL if none */
+	unsigned long replay_len;
+	uint64_t *trace;	/* records of the run (-W), NULL if none */
+	unsigned long trace_len;
+	unsigned long trace_cap;
+	struct bench_event *history;	/* ops of the run (-C), NULL if none */
+	unsigned long history_len;
+	unsigned long history_cap;
+	struct bench_hist *lat;	/* per op type and outcome, NULL if disabled */
+	int lat_countdown;	/* ops left before the next timed one */
+	int latency;
+	struct bench_perf *perf;	/* NULL unless -E */
+	void *set;
+	void *local;		/* structure-specific per-thread state */
+	barrier_t *barrier;
+	const struct bench_ops *ops;
+} __attribute__((aligned(64))) thread_data_t;
+
+/* Structure-specific integer option, e.g. the hash table load factor */
+typedef struct bench_option {
+	int key;
+	const char *name;
+	const char *help;
+	int *value;
+} bench_option_t;
+
+/*
+ * Memory a set holds, as counted by its memory hook: nodes holding a key,
+ * nodes that do not (index levels, sentinels, markers, routing nodes of
+ * external trees) and nodes unlinked but not reclaimed, yet or ever, with
+ * the bytes the first two and the last take.
+ */
+typedef struct bench_mem {
+	long nodes;
+	long index_nodes;
+	long bytes;
+	long retired;
+	long retired_bytes;
+} bench_mem_t;
+
+/*
+ * Operations a data structure registers with the driver. add, remove,
+ * contains and size are mandatory, everything else may be left NULL:
+ * move, snapshot, range and map mode are only offered on the command
+ * line when present.
+ */
+typedef struct bench_ops {
+	const char *name;
+	/* Create an empty set (and start up the STM if any) */
+	void *(*init)(const bench_config_t *cfg);
+	/* Called once the set is populated, before threads start */
+	void (*populated)(void *set, const bench_config_t *cfg);
+	/* Called once threads are stopped, before statistics are printed */
+	void (*finish)(void *set);
+	/* Delete the set (and shut down the STM if any) */
+	void (*destroy)(void *set);
+	void (*thread_enter)(void *set, thread_data_t *d);
+	void (*thread_exit)(void *set, thread_data_t *d);
+	int (*add)(void *set, skey_t key, thread_data_t *d);
+	int (*remove)(void *set, skey_t key, thread_data_t *d);
+	int (*contains)(void *set, skey_t key, thread_data_t *d);
+	long (*size)(void *set);
+	int (*move)(void *set, skey_t from, skey_t to, thread_data_t *d);
+	int (*snapshot)(void *set, thread_data_t *d);
+	/* Extra options, terminated by an entry with key 0 */
+	const bench_option_t *options;
+	/* Default for -x when it selects the algorithm (0 keeps the driver's) */
+	int unit_tx;
+	/*
+	 * Optional, fills the empty set with the n keys, distinct and in
+	 * increasing order, as a balanced structure whose nodes come from
+	 * bench_bulk_alloc() in key order. Called before threads start.
+	 */
+	void (*bulk_build)(void *set, const skey_t *keys, long n, thread_data_t *d);
+	/*
+	 * Optional, counts the memory of the set into the zeroed m, once the
+	 * nb_threads workers whose counters are in data and any maintenance
+	 * thread are stopped.
+	 */
+	void (*memory)(void *set, const thread_data_t *data, int nb_threads, bench_mem_t *m);
+	/*
+	 * Optional, range query: stores the keys of the set in [lo, hi] into
+	 * keys, in increasing order, or only counts them if keys is NULL, and
+	 * returns how many there are.
+	 */
+	long (*range)(void *set, skey_t lo, skey_t hi, skey_t *keys, thread_data_t *d);
+	/* 1 if range queries are linearizable, 0 if only weakly consistent */
+	int range_linearizable;
+	/*
+	 * Optional, map mode (-V): keys map to values of cfg->value_size
+	 * bytes, a multiple of 8, stored by the structure. put adds key
+	 * mapped to a copy of val if absent, get copies the value of key
+	 * into val and overwrite replaces it with a copy of val. put returns
+	 * what add would, get and overwrite what contains would.
+	 */
+	int (*put)(void *set, skey_t key, const void *val, thread_data_t *d);
+	int (*get)(void *set, skey_t key, void *val, thread_data_t *d);
+	int (*overwrite)(void *set, skey_t key, const void *val, thread_data_t *d);
+} bench_ops_t;
+
+/* Parse the command line, run the benchmark and print statistics */
+int bench_main(int argc, char **argv, const bench_ops_t *ops);
+
+/*
+ * Pin the calling thread to its background CPU (-G), to be called first
+ * thing by maintenance threads. Does nothing if placement is disabled.
+ */
+void bench_pin_background(void);
+
+/*
+ * Preemption point, for lock-based structures to call while they hold a
+ * lock: with -y, one call in <n> from a worker deschedules it, as the
+ * scheduler does when threads outnumber the CPUs. bench_locked() is the
+ * same right after taking a lock, passing the result of the lock call
+ * through, e.g. #define LOCK(l) bench_locked(pthread_spin_lock(l)).
+ */
+extern int bench_preempt_every;
+void bench_preempt_slow(void);
+
+static inline void bench_preempt(void)
+{
+	if (bench_preempt_every > 0)
+		bench_preempt_slow();
+}
+
+static inline int bench_locked(int rc)
+{
+	bench_preempt();
+	return rc;
+}
+
+/*
+ * Node storage of bulk_build: consecutive calls return consecutive
+ * 16-byte aligned chunks, which live until the set is destroyed. Their
+ * owner must not free them, bench_bulk_owns() tells them apart.
+ */
+void *bench_bulk_alloc(size_t size);
+int bench_bulk_owns(const void *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H_ */
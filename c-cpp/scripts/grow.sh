@@ -0,0 +1,54 @@
+#!/bin/bash
+
+###
+# This script compares how synchrobench c-cpp 'benchs' executables cope
+# with a set that grows during the run: each starts from 'size' keys and
+# inserts again after 'growth' percent of its successful inserts, with
+# 'update' percent of updates, over a range of 'range' keys. The
+# throughput of every 'interval' milliseconds is printed, one column per
+# executable, so that a hashtable whose bucket count is fixed at start
+# can be told from one that resizes.
+#
+# Select appropriate parameters below, or override them from the
+# environment, e.g. threads=4 duration=20000 ./grow.sh
+#
+benchs=${benchs:-"lockfree-hashtable lockfree-split-hashtable"}
+threads=${threads:-1}
+size=${size:-1024}
+range=${range:-8000000}
+update=${update:-50}
+growth=${growth:-100}
+duration=${duration:-10000}
+interval=${interval:-1000}
+# extra options passed to every run, e.g. "-P compact"
+options=${options:-""}
+###
+
+# path to binaries
+bin=../bin
+
+tmp=$(mktemp -d)
+trap "rm -rf ${tmp}" EXIT
+
+for bench in ${benchs}
+do
+	${bin}/${bench} -u ${update} -g ${growth} -i ${size} -r ${range} \
+		-d ${duration} -t ${threads} -I ${interval} ${options} > ${tmp}/${bench}.out
+	echo "  ${bench}: $(grep '^Set size      :' ${tmp}/${bench}.out)" >&2
+	awk '
+	/^Time series/ { getline; on = 1; next }
+	on && $1 ~ /^[0-9.]+$/ { printf "%.0f,%s\n", $1, $2; next }
+	on { exit }' ${tmp}/${bench}.out > ${tmp}/${bench}
+done
+
+header="time_ms"
+for bench in ${benchs}; do header="${header},${bench}"; done
+echo ${header}
+files=""
+for bench in ${benchs}; do files="${files} ${tmp}/${bench}"; done
+# keep the time column of the first run, the ops/s column of each
+paste -d, ${files} | awk -F, '{
+	line = $1
+	for (i = 2; i <= NF; i += 2) line = line "," $i
+	print line
+}'
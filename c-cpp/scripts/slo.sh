@@ -0,0 +1,75 @@
+#!/bin/bash
+
+###
+# This script searches for the highest open-loop arrival rate (-Q) each
+# of the synchrobench c-cpp 'benchs' executables sustains with 'threads'
+# threads while keeping the 99th percentile latency, timed from when each
+# operation was due, within 'slo' nanoseconds. A rate is sustained if the
+# p99 is met and the threads keep up with at least 'keepup' percent of
+# it. The search bisects the per-thread rate between 'low' and 'high'
+# until they are within 'precision' percent of each other, and prints
+# the total rate found for each executable.
+#
+# Select appropriate parameters below, or override them from the
+# environment, e.g. slo=100000 threads=4 ./slo.sh
+#
+benchs=${benchs:-"ESTM-hashtable lockfree-hashtable MUTEX-hashtable"}
+threads=${threads:-4}
+slo=${slo:-50000}
+low=${low:-1000}
+high=${high:-4000000}
+precision=${precision:-5}
+keepup=${keepup:-95}
+update=${update:-10}
+size=${size:-1024}
+duration=${duration:-2000}
+arrivals=${arrivals:-"poisson"}
+# extra options passed to every run, e.g. "-P compact"
+options=${options:-""}
+###
+
+# path to binaries
+bin=../bin
+
+# make the range twice as large as initial size to maintain size expectation
+r=$((2 * size))
+
+# Prints "<p99> <achieved ops/s>" of a run at per-thread rate $2; the
+# columns are split on commas, so keep -P lists out of the options
+run() {
+	${bin}/$1 -u ${update} -i ${size} -r ${r} -d ${duration} -t ${threads} \
+		-Q $2 -J ${arrivals} ${options} -o csv | tail -2 | awk -F, '
+	NR == 1 { for (i = 1; i <= NF; i++) col[$i] = i; next }
+	{ print $col["lat_p99_ns"], $col["txs_per_s"] }'
+}
+
+# Succeeds if the run at per-thread rate $2 meets the SLO and keeps up
+sustains() {
+	set -- $1 $2 $(run $1 $2)
+	echo "  $1: $2 ops/s per thread, p99 $3 ns, achieved ${4%.*} ops/s" >&2
+	p99=$3
+	[ -n "$3" ] && [ $3 -le ${slo} ] && [ $((${4%.*} * 100)) -ge $(($2 * threads * keepup)) ]
+}
+
+echo "bench,threads,slo_ns,rate_per_thread,rate,p99_ns"
+for bench in ${benchs}
+do
+	if ! sustains ${bench} ${low}; then
+		echo "${bench},${threads},${slo},none"
+		continue
+	fi
+	lo=${low}
+	best="${lo},$((lo * threads)),${p99}"
+	hi=${high}
+	while [ $((hi - lo)) -gt $((hi * precision / 100)) ]
+	do
+		rate=$(((lo + hi) / 2))
+		if sustains ${bench} ${rate}; then
+			lo=${rate}
+			best="${rate},$((rate * threads)),${p99}"
+		else
+			hi=${rate}
+		fi
+	done
+	echo "${bench},${threads},${slo},${best}"
+done
@@ -0,0 +1,99 @@
+#!/bin/bash
+
+###
+# This script sweeps synchrobench c-cpp 'benchs' executables over thread
+# counts 'threads', initial structure sizes 'sizes' and update ratios
+# 'updates', repeating each run 'iterations' times. Each run appends its
+# result record (-o csv) to '../data/${suffix}-raw.csv', then the mean,
+# standard deviation and 95% confidence interval of the throughput of
+# each configuration are written to '../data/${suffix}.csv'.
+#
+# Select appropriate parameters below, or override them from the
+# environment, e.g. threads="1 2 4 8" ./sweep.sh
+#
+threads=${threads:-"1 4"}
+benchs=${benchs:-"ESTM-hashtable lockfree-hashtable MUTEX-hashtable"}
+iterations=${iterations:-5}
+updates=${updates:-"10"}
+sizes=${sizes:-"1024"}
+duration=${duration:-5000}
+# extra options passed to every run, e.g. "-f 0 -P compact"
+options=${options:-""}
+suffix=${suffix:-"synchrobench-sweep"}
+###
+
+# path to binaries
+bin=../bin
+
+if [ ! -d "../data" ]; then
+	mkdir ../data
+fi
+
+raw=../data/${suffix}-raw.csv
+out=../data/${suffix}.csv
+rm -f ${raw}
+
+for size in ${sizes}
+do
+# make the range twice as large as initial size to maintain size expectation
+r=$((2 * size))
+for upd in ${updates}
+do
+ for thread in ${threads}
+ do
+  for bench in ${benchs}
+  do
+   for iter in `seq ${iterations}`
+   do
+     ${bin}/${bench} -u ${upd} -i ${size} -r ${r} -d ${duration} -t ${thread} ${options} -o csv -O ${raw} > /dev/null
+   done
+  done
+  echo "Done ${iterations} runs of ${duration} milliseconds with ${thread} threads, size ${size}, update ${upd}"
+ done
+done
+done
+
+# Group the runs by configuration. Quoted fields may contain commas,
+# the 95% interval uses Student's t for the number of runs.
+awk '
+function split_csv(line, f,    n, q, c, i, cur) {
+	n = 0; q = 0; cur = ""
+	for (i = 1; i <= length(line); i++) {
+		c = substr(line, i, 1)
+		if (c == "\"") q = !q
+		else if (c == "," && !q) { f[++n] = cur; cur = "" }
+		else cur = cur c
+	}
+	f[++n] = cur
+	return n
+}
+function student(df) {
+	if (df >= 30) return 1.960 + 2.4 / df
+	split("12.706 4.303 3.182 2.776 2.571 2.447 2.365 2.306 2.262 2.228 " \
+	      "2.201 2.179 2.160 2.145 2.131 2.120 2.110 2.101 2.093 2.086 " \
+	      "2.080 2.074 2.069 2.064 2.060 2.056 2.052 2.048 2.045", t, " ")
+	return t[df]
+}
+/^bench,/ { split_csv($0, h); for (i in h) col[h[i]] = i; next }
+{
+	split_csv($0, f)
+	key = f[col["bench"]] "," f[col["flavor"]] "," f[col["threads"]] "," \
+	      f[col["initial"]] "," f[col["update"]]
+	if (!(key in n))
+		order[++nkeys] = key
+	x = f[col["txs_per_s"]]
+	n[key]++; sum[key] += x; sq[key] += x * x
+}
+END {
+	print "bench,flavor,threads,initial,update,runs,txs_per_s_mean,txs_per_s_stddev,txs_per_s_ci95"
+	for (k = 1; k <= nkeys; k++) {
+		key = order[k]
+		mean = sum[key] / n[key]
+		var = (n[key] > 1 ? (sq[key] - n[key] * mean * mean) / (n[key] - 1) : 0)
+		sd = (var > 0 ? sqrt(var) : 0)
+		ci = (n[key] > 1 ? student(n[key] - 1) * sd / sqrt(n[key]) : 0)
+		printf "%s,%d,%.3f,%.3f,%.3f\n", key, n[key], mean, sd, ci
+	}
+}' ${raw} > ${out}
+
+cat ${out}
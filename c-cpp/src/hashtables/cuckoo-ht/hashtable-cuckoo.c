@@ -0,0 +1,314 @@
+/*
+ * File:
+ *   hashtable-cuckoo.c
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Optimistic cuckoo hashtable with lock striping, after
+ *   "MemC3: Compact and Concurrent MemCache with Dumber Caching and
+ *   Smarter Hashing" B. Fan, D. G. Andersen, M. Kaminsky, NSDI 2013.
+ *   A key is in one of 2 buckets of 4 slots, so that a lookup reads 2
+ *   buckets at most. An insertion into 2 full buckets first frees a
+ *   slot by moving keys to their other bucket, along the shortest path
+ *   a breadth-first search finds.
+ *
+ * Copyright (c) 2026.
+ *
+ * hashtable-cuckoo.c is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <string.h>
+
+#include "hashtable-cuckoo.h"
+
+/* The 2 buckets of a key are distinct, the table has 2 at least */
+static inline void ck_buckets(ht_intset_t *set, val_t val, unsigned long *b1, unsigned long *b2) {
+	uint64_t h = oa_hash(val);
+
+	*b1 = h & set->mask;
+	*b2 = (h >> 32) & set->mask;
+	if (*b2 == *b1)
+		*b2 = (*b1 + 1) & set->mask;
+}
+
+/* The other bucket of a key in bucket b */
+static inline unsigned long ck_alt(ht_intset_t *set, val_t val, unsigned long b) {
+	unsigned long b1, b2;
+
+	ck_buckets(set, val, &b1, &b2);
+	return (b == b1) ? b2 : b1;
+}
+
+static inline int ck_slot(const ck_bucket_t *b, val_t val) {
+	int i;
+
+	for (i = 0; i < CK_SLOTS; i++)
+		if (b->keys[i] == val)
+			return i;
+	return -1;
+}
+
+static inline ck_stripe_t *ck_stripe(ht_intset_t *set, unsigned long b) {
+	return &set->stripes[b & set->stripe_mask];
+}
+
+/* Locks the stripes of 2 buckets in address order, once if shared */
+static void ck_lock2(ht_intset_t *set, unsigned long b1, unsigned long b2) {
+	ck_stripe_t *s1 = ck_stripe(set, b1), *s2 = ck_stripe(set, b2), *t;
+
+	if (s1 > s2) {
+		t = s1;
+		s1 = s2;
+		s2 = t;
+	}
+	LOCK(&s1->lock);
+	if (s2 != s1)
+		LOCK(&s2->lock);
+}
+
+static void ck_unlock2(ht_intset_t *set, unsigned long b1, unsigned long b2) {
+	ck_stripe_t *s1 = ck_stripe(set, b1), *s2 = ck_stripe(set, b2);
+
+	if (s2 != s1)
+		UNLOCK(&s2->lock);
+	UNLOCK(&s1->lock);
+}
+
+/* Only the holders of the stripe locks change their buckets */
+static inline void ck_write_begin(ck_stripe_t *s1, ck_stripe_t *s2) {
+	s1->version++;
+	if (s2 != s1)
+		s2->version++;
+	AO_nop_full();
+}
+
+static inline void ck_write_end(ck_stripe_t *s1, ck_stripe_t *s2) {
+	AO_nop_full();
+	s1->version++;
+	if (s2 != s1)
+		s2->version++;
+}
+
+/*
+ * Reads both buckets of val without locks, again if a writer changed
+ * either meanwhile. A displaced key is written to its other bucket
+ * before it leaves the first, under the versions of both.
+ */
+int ht_contains(ht_intset_t *set, val_t val, int transactional) {
+	unsigned long b1, b2;
+	ck_stripe_t *s1, *s2;
+	AO_t v1, v2;
+	int found;
+
+	ck_buckets(set, val, &b1, &b2);
+	s1 = ck_stripe(set, b1);
+	s2 = ck_stripe(set, b2);
+	do {
+		while ((v1 = AO_load_acquire(&s1->version)) & 1)
+			;
+		while ((v2 = AO_load_acquire(&s2->version)) & 1)
+			;
+		found = (ck_slot(&set->buckets[b1], val) >= 0 ||
+			 ck_slot(&set->buckets[b2], val) >= 0);
+		AO_nop_full();
+	} while (AO_load(&s1->version) != v1 || AO_load(&s2->version) != v2);
+	return found;
+}
+
+/* An entry of the search, the bucket a key of its parent moves to */
+typedef struct ck_node {
+	unsigned long bucket;
+	int parent;	/* index in the search, -1 for the buckets of the key */
+	int slot;	/* of the key in the parent bucket */
+	int depth;
+} ck_node_t;
+
+static inline void ck_push(ck_node_t *q, int *tail, unsigned long bucket, int parent, int slot, int depth) {
+	q[*tail].bucket = bucket;
+	q[*tail].parent = parent;
+	q[*tail].slot = slot;
+	q[*tail].depth = depth;
+	(*tail)++;
+}
+
+/*
+ * Breadth-first search, without locks, of the shortest path of
+ * displacements that frees a slot in b1 or b2. Returns the index in q of
+ * the bucket with a free slot that ends it, -1 if there is none within
+ * CK_MAX_DEPTH displacements. The buckets may change meanwhile, each
+ * displacement is checked when it is made.
+ */
+static int ck_search(ht_intset_t *set, unsigned long b1, unsigned long b2, ck_node_t *q) {
+	int head, tail = 0, s;
+	val_t k;
+
+	ck_push(q, &tail, b1, -1, -1, 0);
+	ck_push(q, &tail, b2, -1, -1, 0);
+	for (head = 0; head < tail; head++) {
+		for (s = 0; s < CK_SLOTS; s++) {
+			k = set->buckets[q[head].bucket].keys[s];
+			if (k == CK_EMPTY)
+				return head;
+			if (q[head].depth < CK_MAX_DEPTH && tail < CK_MAX_SEARCH)
+				ck_push(q, &tail, ck_alt(set, k, q[head].bucket), head, s, q[head].depth + 1);
+		}
+	}
+	return -1;
+}
+
+/*
+ * Moves the key in the slot of bucket src to a free slot of dst, its
+ * other bucket. Fails if another key that does not belong in dst took
+ * the slot, or dst filled up, since the search.
+ */
+static int ck_displace(ht_intset_t *set, unsigned long src, int slot, unsigned long dst) {
+	ck_bucket_t *bs = &set->buckets[src], *bd = &set->buckets[dst];
+	val_t k;
+	int to, moved = 0;
+
+	ck_lock2(set, src, dst);
+	k = bs->keys[slot];
+	if (k != CK_EMPTY && ck_alt(set, k, src) == dst &&
+	    (to = ck_slot(bd, CK_EMPTY)) >= 0) {
+		ck_write_begin(ck_stripe(set, src), ck_stripe(set, dst));
+		bd->keys[to] = k;
+		bs->keys[slot] = CK_EMPTY;
+		ck_write_end(ck_stripe(set, src), ck_stripe(set, dst));
+		moved = 1;
+	}
+	ck_unlock2(set, src, dst);
+	return moved;
+}
+
+/*
+ * Stores val in a free slot of one of its buckets. If both are full,
+ * the locks are released while a path is searched and its keys are
+ * moved, from the one that goes to a free slot backwards, then the
+ * insertion starts over, as another one may have raced it.
+ */
+int ht_add(ht_intset_t *set, val_t val, int transactional) {
+	ck_node_t q[CK_MAX_SEARCH];
+	ck_bucket_t *bk1, *bk2, *bk;
+	unsigned long b1, b2;
+	int slot, i, len;
+
+	ck_buckets(set, val, &b1, &b2);
+	bk1 = &set->buckets[b1];
+	bk2 = &set->buckets[b2];
+	while (1) {
+		ck_lock2(set, b1, b2);
+		if (ck_slot(bk1, val) >= 0 || ck_slot(bk2, val) >= 0) {
+			ck_unlock2(set, b1, b2);
+			return 0;
+		}
+		bk = bk1;
+		if ((slot = ck_slot(bk, CK_EMPTY)) < 0) {
+			bk = bk2;
+			slot = ck_slot(bk, CK_EMPTY);
+		}
+		if (slot >= 0) {
+			ck_write_begin(ck_stripe(set, b1), ck_stripe(set, b2));
+			bk->keys[slot] = val;
+			ck_write_end(ck_stripe(set, b1), ck_stripe(set, b2));
+			ck_unlock2(set, b1, b2);
+			return 1;
+		}
+		ck_unlock2(set, b1, b2);
+
+		if ((i = ck_search(set, b1, b2, q)) < 0) {
+			printf("ERROR: hashtable full, lower the load factor (-l)\n");
+			exit(1);
+		}
+		len = q[i].depth;
+		for (; q[i].parent >= 0; i = q[i].parent)
+			if (!ck_displace(set, q[q[i].parent].bucket, q[i].slot, q[i].bucket))
+				break;
+		if (q[i].parent >= 0)
+			AO_fetch_and_add1(&set->aborted);
+		else if (len > 0)
+			AO_fetch_and_add1(&set->paths[len]);
+	}
+}
+
+int ht_remove(ht_intset_t *set, val_t val, int transactional) {
+	ck_bucket_t *bk;
+	unsigned long b1, b2;
+	int slot;
+
+	ck_buckets(set, val, &b1, &b2);
+	ck_lock2(set, b1, b2);
+	bk = &set->buckets[b1];
+	if ((slot = ck_slot(bk, val)) < 0) {
+		bk = &set->buckets[b2];
+		slot = ck_slot(bk, val);
+	}
+	if (slot >= 0) {
+		ck_write_begin(ck_stripe(set, b1), ck_stripe(set, b2));
+		bk->keys[slot] = CK_EMPTY;
+		ck_write_end(ck_stripe(set, b1), ck_stripe(set, b2));
+	}
+	ck_unlock2(set, b1, b2);
+	return slot >= 0;
+}
+
+long ht_size(ht_intset_t *set) {
+	long size = 0;
+	unsigned long b;
+	int i;
+
+	for (b = 0; b <= set->mask; b++)
+		for (i = 0; i < CK_SLOTS; i++)
+			if (set->buckets[b].keys[i] != CK_EMPTY)
+				size++;
+	return size;
+}
+
+/* Enough buckets of CK_SLOTS keys for capacity keys, a power of 2 */
+ht_intset_t *ht_new(long capacity) {
+	ht_intset_t *set;
+	unsigned long n, i;
+	int j;
+
+	for (n = 2; n * CK_SLOTS < (unsigned long)capacity; n <<= 1)
+		;
+	if ((set = (ht_intset_t *)malloc(sizeof(ht_intset_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	memset(set, 0, sizeof(ht_intset_t));
+	set->mask = n - 1;
+	set->stripe_mask = (n < CK_MAX_STRIPES ? n : CK_MAX_STRIPES) - 1;
+	if (posix_memalign((void **)&set->buckets, 64, n * sizeof(ck_bucket_t)) != 0 ||
+	    posix_memalign((void **)&set->stripes, 64, (set->stripe_mask + 1) * sizeof(ck_stripe_t)) != 0) {
+		perror("posix_memalign");
+		exit(1);
+	}
+	for (i = 0; i < n; i++)
+		for (j = 0; j < CK_SLOTS; j++)
+			set->buckets[i].keys[j] = CK_EMPTY;
+	for (i = 0; i <= set->stripe_mask; i++) {
+		INIT_LOCK(&set->stripes[i].lock);
+		set->stripes[i].version = 0;
+	}
+	return set;
+}
+
+void ht_delete(ht_intset_t *set) {
+	unsigned long i;
+
+	for (i = 0; i <= set->stripe_mask; i++)
+		DESTROY_LOCK(&set->stripes[i].lock);
+	free(set->stripes);
+	free(set->buckets);
+	free(set);
+}
@@ -0,0 +1,79 @@
+/*
+ * File:
+ *   hashtable-cuckoo.h
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Optimistic cuckoo hashtable with lock striping, after
+ *   "MemC3: Compact and Concurrent MemCache with Dumber Caching and
+ *   Smarter Hashing" B. Fan, D. G. Andersen, M. Kaminsky, NSDI 2013.
+ *
+ * Copyright (c) 2026.
+ *
+ * hashtable-cuckoo.h is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include <atomic_ops.h>
+
+#include "bench.h"
+#include "../open-addressing.h"
+
+#define DEFAULT_LOAD                    80
+#define CK_MAX_LOAD                     95	/* %, insertions may find no cuckoo path */
+
+#define CK_SLOTS                        4	/* keys per bucket */
+#define CK_MAX_STRIPES                  4096
+#define CK_MAX_DEPTH                    5	/* displacements per path */
+#define CK_MAX_SEARCH                   512	/* buckets visited per search */
+
+typedef intptr_t val_t;
+#define CK_EMPTY                        ((val_t)INTPTR_MIN)
+
+/* A key lives in one of the CK_SLOTS slots of one of its 2 buckets */
+typedef struct ck_bucket {
+	val_t keys[CK_SLOTS];
+} ck_bucket_t;
+
+/*
+ * Bucket b is guarded by stripe b % # of stripes. Writers hold its lock
+ * and make version odd while they change one of its buckets, readers
+ * take no lock and retry if the versions of their 2 buckets moved.
+ */
+typedef struct ck_stripe {
+	ptlock_t lock;
+	volatile AO_t version;
+} __attribute__((aligned(64))) ck_stripe_t;
+
+typedef struct ht_intset {
+	ck_bucket_t *buckets;
+	ck_stripe_t *stripes;
+	unsigned long mask;		/* # of buckets - 1 */
+	unsigned long stripe_mask;	/* # of stripes - 1 */
+	/* Displacement paths moved, by length, and abandoned */
+	volatile AO_t paths[CK_MAX_DEPTH + 1];
+	volatile AO_t aborted;
+} ht_intset_t;
+
+ht_intset_t *ht_new(long capacity);
+void ht_delete(ht_intset_t *set);
+long ht_size(ht_intset_t *set);
+int ht_contains(ht_intset_t *set, val_t val, int transactional);
+int ht_add(ht_intset_t *set, val_t val, int transactional);
+int ht_remove(ht_intset_t *set, val_t val, int transactional);
@@ -0,0 +1,133 @@
+/*
+ * File:
+ *   test.c
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Concurrent accesses of a cuckoo hashtable
+ *
+ * Copyright (c) 2026.
+ *
+ * test.c is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "hashtable-cuckoo.h"
+
+#define TRANSACTIONAL                   d->unit_tx
+
+static int load_factor = DEFAULT_LOAD;
+
+static const bench_option_t ht_options[] = {
+	{'l', "load-factor", "Percentage of the slots the initial keys fill", &load_factor},
+	{0, NULL, NULL, NULL}
+};
+
+static void *ht_init(const bench_config_t *cfg)
+{
+	if (load_factor <= 0 || load_factor > CK_MAX_LOAD) {
+		printf("ERROR: Load factor (-l) must be within 1 and %d\n", CK_MAX_LOAD);
+		exit(1);
+	}
+
+	return ht_new(oa_capacity(cfg) * 100 / load_factor);
+}
+
+static void ht_populated(void *set, const bench_config_t *cfg)
+{
+	ht_intset_t *h = (ht_intset_t *)set;
+
+	printf("Bucket amount: %lu (%lu slots, %lu lock stripes)\n", h->mask + 1,
+	       (h->mask + 1) * CK_SLOTS, h->stripe_mask + 1);
+}
+
+/* Paths counted since the start include the ones that populated the set */
+static void ht_finish(void *set)
+{
+	ht_intset_t *h = (ht_intset_t *)set;
+	unsigned long n = 0, sum = 0;
+	int i;
+
+	for (i = 1; i <= CK_MAX_DEPTH; i++) {
+		n += h->paths[i];
+		sum += i * h->paths[i];
+	}
+	printf("Cuckoo paths : %lu moved (mean length %.2f), %lu abandoned\n",
+	       n, n > 0 ? (double)sum / n : 0.0, (unsigned long)h->aborted);
+	for (i = 1; i <= CK_MAX_DEPTH; i++)
+		printf("  length %d   : %lu\n", i, (unsigned long)h->paths[i]);
+}
+
+static void ht_destroy(void *set)
+{
+	ht_delete((ht_intset_t *)set);
+}
+
+static int ht_bench_add(void *set, skey_t key, thread_data_t *d)
+{
+	return ht_add((ht_intset_t *)set, key, TRANSACTIONAL);
+}
+
+static int ht_bench_remove(void *set, skey_t key, thread_data_t *d)
+{
+	return ht_remove((ht_intset_t *)set, key, TRANSACTIONAL);
+}
+
+static int ht_bench_contains(void *set, skey_t key, thread_data_t *d)
+{
+	return ht_contains((ht_intset_t *)set, key, TRANSACTIONAL);
+}
+
+static long ht_bench_size(void *set)
+{
+	return ht_size((ht_intset_t *)set);
+}
+
+/* Keys are stored in the buckets, which are all allocated upfront */
+static void ht_memory(void *set, const thread_data_t *data, int nb_threads, bench_mem_t *m)
+{
+	ht_intset_t *h = (ht_intset_t *)set;
+
+	m->nodes = ht_size(h);
+	m->bytes = sizeof(ht_intset_t) + (h->mask + 1) * sizeof(ck_bucket_t) +
+		(h->stripe_mask + 1) * sizeof(ck_stripe_t);
+}
+
+static const bench_ops_t ht_ops = {
+	"cuckoo hash table",
+	ht_init,
+	ht_populated,
+	ht_finish,
+	ht_destroy,
+	NULL,
+	NULL,
+	ht_bench_add,
+	ht_bench_remove,
+	ht_bench_contains,
+	ht_bench_size,
+	NULL,
+	NULL,
+	ht_options,
+	0,
+	NULL,
+	ht_memory,
+	NULL,
+	0,
+	NULL,
+	NULL,
+	NULL
+};
+
+int main(int argc, char **argv)
+{
+	return bench_main(argc, argv, &ht_ops);
+}
@@ -0,0 +1,371 @@
+/*
+ * File:
+ *   hashtable-hopscotch.c
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Concurrent hopscotch hashtable of Herlihy, Shavit and Tzafrir
+ *   "Hopscotch Hashing" M. Herlihy, N. Shavit, M. Tzafrir, DISC 2008.
+ *   Keys are stored in the table itself, within HS_HOP_RANGE buckets of
+ *   their home bucket, whose bitmap tells where. An insertion that only
+ *   finds a free bucket further away moves keys closer to their own
+ *   home, into it, until the free bucket is in range. This keeps lookups
+ *   short at load factors that chaining pays for with a node per key.
+ *   The table does not grow: a key that no key can make room for, at
+ *   load factors past 90%, is stashed in a list of its home segment.
+ *
+ * Copyright (c) 2026.
+ *
+ * hashtable-hopscotch.c is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <sched.h>
+#include <string.h>
+
+#include "hashtable-hopscotch.h"
+
+static inline hs_segment_t *hs_segment(ht_intset_t *set, unsigned long b) {
+	return &set->segments[b / set->segment_size];
+}
+
+/* Bucket b, at most twice the table away, wrapped around without a division */
+static inline unsigned long hs_wrap(ht_intset_t *set, unsigned long b) {
+	return (b < set->nb_buckets) ? b : b - set->nb_buckets;
+}
+
+/* Distance from bucket from to bucket to, going forward */
+#define HS_DIST(set, from, to)          hs_wrap(set, (to) + (set)->nb_buckets - (from))
+#define HS_AT(set, b, i)                (&(set)->buckets[hs_wrap(set, (b) + (i))])
+
+/*
+ * Scans the neighborhood of the home bucket without locks, again if a
+ * key homed in the same segment was displaced meanwhile.
+ */
+int ht_contains(ht_intset_t *set, val_t val, int transactional) {
+	unsigned long home = oa_hash(val) % set->nb_buckets;
+	hs_segment_t *seg = hs_segment(set, home);
+	AO_t ts;
+	uint64_t hop;
+
+	hs_node_t *n;
+
+	do {
+		ts = AO_load_acquire(&seg->timestamp);
+		for (hop = set->buckets[home].hop_info; hop != 0; hop &= hop - 1)
+			if (HS_AT(set, home, __builtin_ctzll(hop))->key == val)
+				return 1;
+		AO_nop_full();
+	} while (AO_load(&seg->timestamp) != ts);
+	if (AO_load_full(&seg->stashed) > 0)
+		for (n = seg->stash; n != NULL; n = n->next)
+			if (n->key == val)
+				return 1;
+	return 0;
+}
+
+/* Index of val in the neighborhood of home, -1 if absent, under its lock */
+static int hs_find(ht_intset_t *set, unsigned long home, val_t val) {
+	uint64_t hop;
+
+	for (hop = set->buckets[home].hop_info; hop != 0; hop &= hop - 1)
+		if (HS_AT(set, home, __builtin_ctzll(hop))->key == val)
+			return __builtin_ctzll(hop);
+	return -1;
+}
+
+/* Stash node holding val, NULL if none, under the lock of its segment */
+static hs_node_t *hs_stash_find(hs_segment_t *seg, val_t val) {
+	hs_node_t *n;
+
+	if (seg->stashed == 0)
+		return NULL;
+	for (n = seg->stash; n != NULL; n = n->next)
+		if (n->key == val)
+			return n;
+	return NULL;
+}
+
+/*
+ * Stores val in a removed node of the stash of its segment, or in a new
+ * one published once its key is set, under the lock of the segment.
+ */
+static void hs_stash(ht_intset_t *set, hs_segment_t *seg, val_t val) {
+	hs_node_t *n;
+
+	for (n = seg->stash; n != NULL && n->key != HS_EMPTY; n = n->next)
+		;
+	if (n == NULL) {
+		if ((n = (hs_node_t *)malloc(sizeof(hs_node_t))) == NULL) {
+			perror("malloc");
+			exit(1);
+		}
+		n->key = val;
+		n->next = seg->stash;
+		AO_nop_full();
+		seg->stash = n;
+		AO_fetch_and_add1(&set->stash_nodes);
+	} else {
+		n->key = val;
+	}
+	AO_fetch_and_add1_full(&seg->stashed);
+}
+
+/*
+ * Moves the key homed at j from i to d buckets further, which is
+ * reserved, under the lock of the segment of j. The key is copied
+ * before it is erased, and the timestamp moves in between, so that a
+ * lookup that missed it starts over. Bucket i is left reserved.
+ */
+static void hs_move(ht_intset_t *set, unsigned long j, int i, int d) {
+	hs_bucket_t *home = &set->buckets[j];
+
+	HS_AT(set, j, d)->key = HS_AT(set, j, i)->key;
+	AO_nop_full();
+	home->hop_info |= 1ULL << d;
+	AO_nop_full();
+	hs_segment(set, j)->timestamp++;
+	AO_nop_full();
+	home->hop_info &= ~(1ULL << i);
+	HS_AT(set, j, i)->key = HS_BUSY;
+	AO_fetch_and_add1(&set->hops);
+}
+
+/* Locks the segment of bucket j, unless already held, by trying only */
+static int hs_trylock(ht_intset_t *set, hs_segment_t *held, unsigned long j) {
+	hs_segment_t *seg = hs_segment(set, j);
+
+	if (seg == held)
+		return 1;
+	if (TRYLOCK(&seg->lock) != 0)
+		return 0;
+	bench_preempt();
+	return 1;
+}
+
+static void hs_unlock(ht_intset_t *set, hs_segment_t *held, unsigned long j) {
+	hs_segment_t *seg = hs_segment(set, j);
+
+	if (seg != held)
+		UNLOCK(&seg->lock);
+}
+
+/*
+ * Moves a key into the empty bucket, which is reserved, from one of the
+ * HS_HOP_RANGE - 1 buckets before it whose home is in range of it, and
+ * returns the bucket it freed. The closest home is tried first, so
+ * that keys are not pushed to the end of their neighborhood. Returns -1
+ * if no key may move, -2 if a lock was taken or if a bucket before it is
+ * reserved by another insertion, whose key may then move instead.
+ */
+static long hs_hop(ht_intset_t *set, hs_segment_t *held, unsigned long empty) {
+	unsigned long j;
+	uint64_t hop;
+	int d, i, busy = 0;
+
+	for (d = 1; d < HS_HOP_RANGE; d++) {
+		j = hs_wrap(set, empty + set->nb_buckets - d);
+		if (set->buckets[j].key == HS_BUSY)
+			busy = 1;
+		if ((set->buckets[j].hop_info & ((1ULL << d) - 1)) == 0)
+			continue;
+		if (!hs_trylock(set, held, j))
+			return -2;
+		/* The keys of j cannot have changed but under its lock */
+		hop = set->buckets[j].hop_info & ((1ULL << d) - 1);
+		if (hop != 0) {
+			i = __builtin_ctzll(hop);
+			hs_move(set, j, i, d);
+		}
+		hs_unlock(set, held, j);
+		if (hop != 0)
+			return (long)hs_wrap(set, j + i);
+	}
+	return busy ? -2 : -1;
+}
+
+/*
+ * Fills the bucket a removal reserved with the next key that is further
+ * from its home, then the bucket that key left, and so on, before it
+ * frees the last one. Otherwise keys only ever move away from their
+ * home, and once they all sit at the end of their neighborhood, at a
+ * high load factor, no insertion can hop a bucket back. A key whose
+ * segment is busy stays, compacting is not needed to be correct.
+ */
+static void hs_compact(ht_intset_t *set, hs_segment_t *held, unsigned long hole) {
+	unsigned long j, x;
+	val_t key;
+	int k, d;
+
+	for (k = 1; k < HS_HOP_RANGE; k++) {
+		x = hs_wrap(set, hole + k);
+		key = set->buckets[x].key;
+		if (key == HS_EMPTY || key == HS_BUSY)
+			continue;
+		j = oa_hash(key) % set->nb_buckets;
+		if ((d = (int)HS_DIST(set, j, x)) < k)
+			continue;
+		if (!hs_trylock(set, held, j))
+			continue;
+		/* The key may have moved or gone before the lock */
+		if (set->buckets[x].key == key && (set->buckets[j].hop_info & (1ULL << d))) {
+			hs_move(set, j, d, d - k);
+			hole = x;
+			k = 0;
+		}
+		hs_unlock(set, held, j);
+	}
+	set->buckets[hole].key = HS_EMPTY;
+}
+
+/*
+ * Reserves the first empty bucket from home, then hops it back until it
+ * is in the neighborhood of home. Other inserters may reserve buckets
+ * concurrently, whatever their home.
+ */
+int ht_add(ht_intset_t *set, val_t val, int transactional) {
+	unsigned long home = oa_hash(val) % set->nb_buckets, i;
+	hs_segment_t *seg = hs_segment(set, home);
+	long empty;
+	int busy;
+
+ retry:
+	LOCK(&seg->lock);
+	if (hs_find(set, home, val) >= 0 || hs_stash_find(seg, val) != NULL) {
+		UNLOCK(&seg->lock);
+		return 0;
+	}
+	for (i = 0, busy = 0; i < set->nb_buckets; i++) {
+		empty = (long)hs_wrap(set, home + i);
+		if (set->buckets[empty].key == HS_BUSY)
+			busy = 1;
+		if (set->buckets[empty].key == HS_EMPTY &&
+		    AO_compare_and_swap_full((volatile AO_t *)&set->buckets[empty].key,
+					     (AO_t)HS_EMPTY, (AO_t)HS_BUSY))
+			break;
+	}
+	if (i == set->nb_buckets) {
+		/* Reserved buckets are released on a retry, or filled and removed */
+		UNLOCK(&seg->lock);
+		if (!busy) {
+			printf("ERROR: hashtable full, lower the load factor (-l)\n");
+			exit(1);
+		}
+		sched_yield();
+		goto retry;
+	}
+	while (HS_DIST(set, home, (unsigned long)empty) >= HS_HOP_RANGE) {
+		long x = hs_hop(set, seg, (unsigned long)empty);
+
+		if (x == -2) {
+			set->buckets[empty].key = HS_EMPTY;
+			UNLOCK(&seg->lock);
+			sched_yield();
+			goto retry;
+		}
+		if (x == -1) {
+			set->buckets[empty].key = HS_EMPTY;
+			hs_stash(set, seg, val);
+			UNLOCK(&seg->lock);
+			return 1;
+		}
+		empty = x;
+	}
+	set->buckets[empty].key = val;
+	AO_nop_full();
+	set->buckets[home].hop_info |= 1ULL << HS_DIST(set, home, (unsigned long)empty);
+	UNLOCK(&seg->lock);
+	return 1;
+}
+
+int ht_remove(ht_intset_t *set, val_t val, int transactional) {
+	unsigned long home = oa_hash(val) % set->nb_buckets;
+	hs_segment_t *seg = hs_segment(set, home);
+	hs_node_t *n = NULL;
+	int i;
+
+	LOCK(&seg->lock);
+	if ((i = hs_find(set, home, val)) >= 0) {
+		set->buckets[home].hop_info &= ~(1ULL << i);
+		AO_nop_full();
+		HS_AT(set, home, i)->key = HS_BUSY;
+		hs_compact(set, seg, hs_wrap(set, home + i));
+	} else if ((n = hs_stash_find(seg, val)) != NULL) {
+		n->key = HS_EMPTY;
+		AO_fetch_and_sub1_full(&seg->stashed);
+	}
+	UNLOCK(&seg->lock);
+	return i >= 0 || n != NULL;
+}
+
+long ht_size(ht_intset_t *set) {
+	long size = 0;
+	unsigned long b;
+
+	for (b = 0; b < set->nb_buckets; b++)
+		if (set->buckets[b].key != HS_EMPTY && set->buckets[b].key != HS_BUSY)
+			size++;
+	for (b = 0; b < set->nb_segments; b++)
+		size += set->segments[b].stashed;
+	return size;
+}
+
+/*
+ * Exactly capacity buckets, not a power of 2, for the load factor to be
+ * the one asked, as the table does not grow.
+ */
+ht_intset_t *ht_new(long capacity) {
+	ht_intset_t *set;
+	unsigned long n, i;
+
+	n = (capacity > HS_HOP_RANGE ? (unsigned long)capacity : HS_HOP_RANGE);
+	if ((set = (ht_intset_t *)malloc(sizeof(ht_intset_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	memset(set, 0, sizeof(ht_intset_t));
+	set->nb_buckets = n;
+	set->segment_size = (n + HS_MAX_SEGMENTS - 1) / HS_MAX_SEGMENTS;
+	set->nb_segments = (n + set->segment_size - 1) / set->segment_size;
+	if (posix_memalign((void **)&set->buckets, 64, n * sizeof(hs_bucket_t)) != 0 ||
+	    posix_memalign((void **)&set->segments, 64, set->nb_segments * sizeof(hs_segment_t)) != 0) {
+		perror("posix_memalign");
+		exit(1);
+	}
+	for (i = 0; i < n; i++) {
+		set->buckets[i].hop_info = 0;
+		set->buckets[i].key = HS_EMPTY;
+	}
+	for (i = 0; i < set->nb_segments; i++) {
+		INIT_LOCK(&set->segments[i].lock);
+		set->segments[i].timestamp = 0;
+		set->segments[i].stash = NULL;
+		set->segments[i].stashed = 0;
+	}
+	return set;
+}
+
+void ht_delete(ht_intset_t *set) {
+	hs_node_t *n, *next;
+	unsigned long i;
+
+	for (i = 0; i < set->nb_segments; i++) {
+		for (n = set->segments[i].stash; n != NULL; n = next) {
+			next = n->next;
+			free(n);
+		}
+		DESTROY_LOCK(&set->segments[i].lock);
+	}
+	free(set->segments);
+	free(set->buckets);
+	free(set);
+}
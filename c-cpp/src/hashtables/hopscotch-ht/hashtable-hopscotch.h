@@ -0,0 +1,90 @@
+/*
+ * File:
+ *   hashtable-hopscotch.h
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Concurrent hopscotch hashtable of Herlihy, Shavit and Tzafrir
+ *   "Hopscotch Hashing" M. Herlihy, N. Shavit, M. Tzafrir, DISC 2008.
+ *
+ * Copyright (c) 2026.
+ *
+ * hashtable-hopscotch.h is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include <atomic_ops.h>
+
+#include "bench.h"
+#include "../open-addressing.h"
+
+#define DEFAULT_LOAD                    80
+
+#define HS_HOP_RANGE                    64	/* neighborhood, bits of hop_info */
+#define HS_MAX_SEGMENTS                 4096
+
+typedef intptr_t val_t;
+#define HS_EMPTY                        ((val_t)INTPTR_MIN)
+#define HS_BUSY                         ((val_t)INTPTR_MIN + 1)
+
+/*
+ * Bit i of hop_info is set if the key homed at this bucket is stored
+ * i buckets further, each key is within HS_HOP_RANGE of its home.
+ */
+typedef struct hs_bucket {
+	volatile uint64_t hop_info;
+	volatile val_t key;
+} hs_bucket_t;
+
+/* A key that no key could make room for in its neighborhood */
+typedef struct hs_node {
+	volatile val_t key;		/* HS_EMPTY once removed, for reuse */
+	struct hs_node *next;
+} hs_node_t;
+
+/*
+ * A segment is a range of consecutive buckets. Its lock serializes the
+ * updates of the keys homed there, its timestamp moves whenever one of
+ * them is displaced, for lookups to retry. Keys homed there that found
+ * no room in their neighborhood are stashed in its list, which only
+ * grows, so that lookups may walk it without lock.
+ */
+typedef struct hs_segment {
+	ptlock_t lock;
+	volatile AO_t timestamp;
+	hs_node_t *volatile stash;
+	volatile AO_t stashed;		/* keys in the stash */
+} __attribute__((aligned(64))) hs_segment_t;
+
+typedef struct ht_intset {
+	hs_bucket_t *buckets;
+	hs_segment_t *segments;
+	unsigned long nb_buckets;
+	unsigned long segment_size;	/* buckets per segment */
+	unsigned long nb_segments;
+	volatile AO_t hops;		/* keys displaced towards their home */
+	volatile AO_t stash_nodes;	/* allocated in all the stashes */
+} ht_intset_t;
+
+ht_intset_t *ht_new(long capacity);
+void ht_delete(ht_intset_t *set);
+long ht_size(ht_intset_t *set);
+int ht_contains(ht_intset_t *set, val_t val, int transactional);
+int ht_add(ht_intset_t *set, val_t val, int transactional);
+int ht_remove(ht_intset_t *set, val_t val, int transactional);
@@ -0,0 +1,128 @@
+/*
+ * File:
+ *   test.c
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Concurrent accesses of a hopscotch hashtable
+ *
+ * Copyright (c) 2026.
+ *
+ * test.c is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "hashtable-hopscotch.h"
+
+#define TRANSACTIONAL                   d->unit_tx
+
+static int load_factor = DEFAULT_LOAD;
+
+static const bench_option_t ht_options[] = {
+	{'l', "load-factor", "Percentage of the buckets the initial keys fill", &load_factor},
+	{0, NULL, NULL, NULL}
+};
+
+static void *ht_init(const bench_config_t *cfg)
+{
+	if (load_factor <= 0 || load_factor > 100) {
+		printf("ERROR: Load factor (-l) must be within 1 and 100\n");
+		exit(1);
+	}
+
+	return ht_new(oa_capacity(cfg) * 100 / load_factor);
+}
+
+static void ht_populated(void *set, const bench_config_t *cfg)
+{
+	ht_intset_t *h = (ht_intset_t *)set;
+
+	printf("Bucket amount: %lu (%lu segments, neighborhood of %d)\n", h->nb_buckets,
+	       h->nb_segments, HS_HOP_RANGE);
+}
+
+/* Keys displaced since the start include the ones that populated the set */
+static void ht_finish(void *set)
+{
+	ht_intset_t *h = (ht_intset_t *)set;
+	unsigned long stashed = 0, i;
+
+	for (i = 0; i < h->nb_segments; i++)
+		stashed += h->segments[i].stashed;
+	printf("Hopscotch    : %lu keys displaced, %lu stashed\n", (unsigned long)h->hops,
+	       stashed);
+}
+
+static void ht_destroy(void *set)
+{
+	ht_delete((ht_intset_t *)set);
+}
+
+static int ht_bench_add(void *set, skey_t key, thread_data_t *d)
+{
+	return ht_add((ht_intset_t *)set, key, TRANSACTIONAL);
+}
+
+static int ht_bench_remove(void *set, skey_t key, thread_data_t *d)
+{
+	return ht_remove((ht_intset_t *)set, key, TRANSACTIONAL);
+}
+
+static int ht_bench_contains(void *set, skey_t key, thread_data_t *d)
+{
+	return ht_contains((ht_intset_t *)set, key, TRANSACTIONAL);
+}
+
+static long ht_bench_size(void *set)
+{
+	return ht_size((ht_intset_t *)set);
+}
+
+/* Keys are stored in the buckets, all allocated upfront, or stashed */
+static void ht_memory(void *set, const thread_data_t *data, int nb_threads, bench_mem_t *m)
+{
+	ht_intset_t *h = (ht_intset_t *)set;
+
+	m->nodes = ht_size(h);
+	m->bytes = sizeof(ht_intset_t) + h->nb_buckets * sizeof(hs_bucket_t) +
+		h->nb_segments * sizeof(hs_segment_t) + h->stash_nodes * sizeof(hs_node_t);
+}
+
+static const bench_ops_t ht_ops = {
+	"hopscotch hash table",
+	ht_init,
+	ht_populated,
+	ht_finish,
+	ht_destroy,
+	NULL,
+	NULL,
+	ht_bench_add,
+	ht_bench_remove,
+	ht_bench_contains,
+	ht_bench_size,
+	NULL,
+	NULL,
+	ht_options,
+	0,
+	NULL,
+	ht_memory,
+	NULL,
+	0,
+	NULL,
+	NULL,
+	NULL
+};
+
+int main(int argc, char **argv)
+{
+	return bench_main(argc, argv, &ht_ops);
+}
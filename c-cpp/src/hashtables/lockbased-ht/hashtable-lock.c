@@ -33,14 +33,16 @@ void ht_delete(ht_intset_t *set) {
 	int i;
 	
 	for (i=0; i < maxhtlength; i++) {
-		node = set->buckets[i]->head;
-		while (node != NULL) {
+		node = set->buckets[i].min.next;
+		while (node != &set->buckets[i].max) {
 			next = node->next;
-      free(node);
+			node_delete_l(node);
 			node = next;
 		}
-		free(set->buckets[i]);
+		DESTROY_LOCK(&set->buckets[i].min.lock);
+		DESTROY_LOCK(&set->buckets[i].max.lock);
 	}
+	free(set->buckets);
 	free(set);
 }
 
@@ -50,7 +52,7 @@ int ht_size(ht_intset_t *set) {
 	int i;
 	
 	for (i=0; i < maxhtlength; i++) {
-		node = set->buckets[i]->head->next;
+		node = set->buckets[i].min.next;
 		while (node->next) {
 			size++;
 			node = node->next;
@@ -73,14 +75,26 @@ int floor_log_2(unsigned int n) {
 
 ht_intset_t *ht_new() {
 	ht_intset_t *set;
+	ht_bucket_t *b;
 	int i;
 	
 	if ((set = (ht_intset_t *)malloc(sizeof(ht_intset_t))) == NULL) {
 		perror("malloc");
 		exit(1);
 	}   
+	if (posix_memalign((void **)&set->buckets, 64, maxhtlength * sizeof(ht_bucket_t)) != 0) {
+		perror("posix_memalign");
+		exit(1);
+	}
 	for (i=0; i < maxhtlength; i++) {
-		set->buckets[i] = set_new_l();
+		b = &set->buckets[i];
+		b->max.val = VAL_MAX;
+		b->max.next = NULL;
+		INIT_LOCK(&b->max.lock);
+		b->min.val = VAL_MIN;
+		b->min.next = &b->max;
+		INIT_LOCK(&b->min.lock);
+		b->set.head = &b->min;
 	}
 	return set;
 }
@@ -90,7 +104,7 @@ int ht_contains(ht_intset_t *set, int val, int transactional) {
 	
 	/* Get key */
 	addr = val % maxhtlength;
-	return set_contains_l(set->buckets[addr], val, transactional);
+	return set_contains_l(&set->buckets[addr].set, val, transactional);
 }
 
 int ht_add(ht_intset_t *set, int val, int transactional) {
@@ -98,7 +112,7 @@ int ht_add(ht_intset_t *set, int val, int transactional) {
 	
 	/* Get key */
 	addr = val % maxhtlength;
-	result = set_add_l(set->buckets[addr], val, transactional);
+	result = set_add_l(&set->buckets[addr].set, val, transactional);
 	return result;
 }
 
@@ -107,7 +121,7 @@ int ht_remove(ht_intset_t *set, int val, int transactional) {
 	
 	/* Get key */
 	addr = val % maxhtlength;
-	result = set_remove_l(set->buckets[addr], val, transactional);
+	result = set_remove_l(&set->buckets[addr].set, val, transactional);
 	
 	return result;
 }
@@ -128,7 +142,7 @@ int ht_move(ht_intset_t *set, int val1, int val2, int transactional) {
 	
 	// records pred and succ of val1
 	addr1 = val1 % maxhtlength;
-	pred1 = set->buckets[addr1]->head;
+	pred1 = set->buckets[addr1].set.head;
 	curr1 = pred1->next;
 	while (curr1->val < val1) {
 		pred1 = curr1;
@@ -136,7 +150,7 @@ int ht_move(ht_intset_t *set, int val1, int val2, int transactional) {
 	}
 	// records pred and succ of val2 
 	addr2 = val2 % maxhtlength;
-	pred2 = set->buckets[addr2]->head;
+	pred2 = set->buckets[addr2].set.head;
 	curr2 = pred2->next;
 	while (curr2->val < val2) {
 		pred2 = curr2;
@@ -186,8 +200,8 @@ int ht_snapshot_unmovable(ht_intset_t *set, int transactional) {
 	int sum = 0;
 	
 	for (i=0; i < maxhtlength; i++) {
-		curr = set->buckets[i]->head;
-		next = set->buckets[i]->head->next;
+		curr = set->buckets[i].set.head;
+		next = set->buckets[i].set.head->next;
 		
   		//pthread_mutex_lock((pthread_mutex_t *) &next->lock);
 		LOCK(&next->lock);
@@ -218,10 +232,10 @@ int ht_snapshot(ht_intset_t *set, int transactional) {
 	
 	for (i=0; i < m; i++) {
 	  do {
-	    LOCK(&set->buckets[i]->head->lock);
-	    LOCK(&set->buckets[i]->head->next->lock);
-	    curr = set->buckets[i]->head;
-	    next = set->buckets[i]->head->next;
+	    LOCK(&set->buckets[i].set.head->lock);
+	    LOCK(&set->buckets[i].set.head->next->lock);
+	    curr = set->buckets[i].set.head;
+	    next = set->buckets[i].set.head->next;
 	  } while (!parse_validate(curr, next));
 
 	  while (next->next) {
@@ -240,8 +254,8 @@ int ht_snapshot(ht_intset_t *set, int transactional) {
 	}
 	
 	for (i=0; i < m; i++) {
-	  curr = set->buckets[i]->head;
-	  next = set->buckets[i]->head->next;
+	  curr = set->buckets[i].set.head;
+	  next = set->buckets[i].set.head->next;
 	  
 	  UNLOCK(&curr->lock);
 	  UNLOCK(&next->lock);
@@ -33,8 +33,6 @@
 #define DEFAULT_ALTERNATE               0
 #define DEFAULT_EFFECTIVE               1
 
-#define MAXHTLENGTH                     65536
-
 /* Hashtable length (# of buckets) */
 extern unsigned int maxhtlength;
 
@@ -42,8 +40,19 @@ extern unsigned int maxhtlength;
  * HASH TABLE
  * ################################################################### */
 
+/*
+ * The sentinels of each list live in its bucket, next to the head the
+ * list operations follow, so that reaching the first node of a bucket
+ * does not first miss on a pointer, a separate intset and a head node.
+ */
+typedef struct ht_bucket {
+	intset_l_t set;			/* set.head is &min */
+	node_l_t min;
+	node_l_t max;
+} __attribute__((aligned(64))) ht_bucket_t;
+
 typedef struct ht_intset {
-	intset_l_t *buckets[MAXHTLENGTH];
+	ht_bucket_t *buckets;		/* maxhtlength of them */
 } ht_intset_t;
 
 void ht_delete(ht_intset_t *set);
@@ -31,13 +31,12 @@ void ht_delete(ht_intset_t *set) {
   int i;
   
   for (i=0; i < maxhtlength; i++) {
-    node = set->buckets[i]->head;
-    while (node != NULL) {
+    node = set->buckets[i].min.next;
+    while (node != &set->buckets[i].max) {
       next = node->next;
       free(node);
       node = next;
     }
-    free(set->buckets[i]);
   }
   free(set->buckets);
   free(set);
@@ -49,7 +48,7 @@ int ht_size(ht_intset_t *set) {
 	int i;
 	
 	for (i=0; i < maxhtlength; i++) {
-		node = set->buckets[i]->head->next;
+		node = set->buckets[i].min.next;
 		while (node->next) {
 			size++;
 			node = node->next;
@@ -73,19 +72,25 @@ int floor_log_2(unsigned int n) {
 
 ht_intset_t *ht_new() {
 	ht_intset_t *set;
+	ht_bucket_t *b;
 	int i;
 	
 	if ((set = (ht_intset_t *)malloc(sizeof(ht_intset_t))) == NULL) {
 		perror("malloc");
 		exit(1);
 	}  
-        if ((set->buckets = (void *)malloc((maxhtlength + 1)* sizeof(intset_t *))) == NULL) {
-	perror("malloc");
-	exit(1);
-	}  
+	if (posix_memalign((void **)&set->buckets, 64, maxhtlength * sizeof(ht_bucket_t)) != 0) {
+		perror("posix_memalign");
+		exit(1);
+	}
 
 	for (i=0; i < maxhtlength; i++) {
-		set->buckets[i] = set_new();
+		b = &set->buckets[i];
+		b->max.val = VAL_MAX;
+		b->max.next = NULL;
+		b->min.val = VAL_MIN;
+		b->min.next = &b->max;
+		b->set.head = &b->min;
 	}
 	return set;
 }
@@ -30,8 +30,6 @@
 #define DEFAULT_ALTERNATE               0
 #define DEFAULT_EFFECTIVE               1
 
-#define MAXHTLENGTH                     65536
-
 /* Hashtable length (# of buckets) */
 extern unsigned int maxhtlength;
 
@@ -42,8 +40,19 @@ extern __thread unsigned int *rng_seed;
 extern pthread_key_t rng_seed_key;
 #endif /* ! TLS */
 
+/*
+ * The sentinels of each list live in its bucket, next to the head the
+ * list operations follow, so that reaching the first node of a bucket
+ * does not first miss on a pointer, a separate intset and a head node.
+ */
+typedef struct ht_bucket {
+  intset_t set;			/* set.head is &min */
+  node_t min;
+  node_t max;
+} __attribute__((aligned(64))) ht_bucket_t;
+
 typedef struct ht_intset {
-  intset_t **buckets;
+  ht_bucket_t *buckets;		/* maxhtlength of them */
 } ht_intset_t;
 
 void ht_delete(ht_intset_t *set);
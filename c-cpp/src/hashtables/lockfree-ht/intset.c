@@ -28,9 +28,9 @@ int ht_contains(ht_intset_t *set, int val, int transactional) {
 	
 	addr = val % maxhtlength;
 	if (transactional == 5)
-	  return set_contains(set->buckets[addr], val, 4);
+	  return set_contains(&set->buckets[addr].set, val, 4);
 	else
-	  return set_contains(set->buckets[addr], val, transactional);
+	  return set_contains(&set->buckets[addr].set, val, transactional);
 }
 
 int ht_add(ht_intset_t *set, int val, int transactional) {
@@ -38,9 +38,9 @@ int ht_add(ht_intset_t *set, int val, int transactional) {
 	
 	addr = val % maxhtlength;
 	if (transactional == 5)
-		return set_add(set->buckets[addr], val, 4);
+		return set_add(&set->buckets[addr].set, val, 4);
 	else 
-		return set_add(set->buckets[addr], val, transactional);
+		return set_add(&set->buckets[addr].set, val, transactional);
 }
 
 int ht_remove(ht_intset_t *set, int val, int transactional) {
@@ -48,9 +48,9 @@ int ht_remove(ht_intset_t *set, int val, int transactional) {
     
 	addr = val % maxhtlength;
 	if (transactional == 5)
-		return set_remove(set->buckets[addr], val, 4);
+		return set_remove(&set->buckets[addr].set, val, 4);
 	else
-		return set_remove(set->buckets[addr], val, transactional);
+		return set_remove(&set->buckets[addr].set, val, transactional);
 }
 
 /* 
@@ -70,8 +70,8 @@ int ht_move_naive(ht_intset_t *set, int val1, int val2, int transactional) {
 		
 	addr1 = val1 % maxhtlength;
 	addr2 = val2 % maxhtlength;
-	result =  (set_remove(set->buckets[addr1], val1, transactional) && 
-			   set_add(set->buckets[addr2], val2, transactional));
+	result =  (set_remove(&set->buckets[addr1].set, val1, transactional) && 
+			   set_add(&set->buckets[addr2].set, val2, transactional));
 	
 #elif defined STM
 	
@@ -82,7 +82,7 @@ int ht_move_naive(ht_intset_t *set, int val1, int val2, int transactional) {
 	  
 	  TX_START(EL);
 	  addr1 = val1 % maxhtlength;
-	  prev = (node_t *)TX_LOAD(&set->buckets[addr1]->head);
+	  prev = (node_t *)TX_LOAD(&set->buckets[addr1].set.head);
 	  next = (node_t *)TX_LOAD(&prev->next);
 	  while(1) {
 	    v = TX_LOAD(&next->val);
@@ -97,7 +97,7 @@ int ht_move_naive(ht_intset_t *set, int val1, int val2, int transactional) {
 	    FREE(next, sizeof(node_t));
 	    /* Inserting */
 	    addr2 = val2 % maxhtlength;
-	    prev = (node_t *)TX_LOAD(&set->buckets[addr2]->head);
+	    prev = (node_t *)TX_LOAD(&set->buckets[addr2].set.head);
 	    next = (node_t *)TX_LOAD(&prev->next);
 	    while(1) {
 	      v = TX_LOAD(&next->val);
@@ -117,7 +117,7 @@ int ht_move_naive(ht_intset_t *set, int val1, int val2, int transactional) {
 
 	  TX_START(NL);
 	  addr1 = val1 % maxhtlength;
-	  prev = (node_t *)TX_LOAD(&set->buckets[addr1]->head);
+	  prev = (node_t *)TX_LOAD(&set->buckets[addr1].set.head);
 	  next = (node_t *)TX_LOAD(&prev->next);
 	  while(1) {
 	    v = TX_LOAD(&next->val);
@@ -132,7 +132,7 @@ int ht_move_naive(ht_intset_t *set, int val1, int val2, int transactional) {
 	    FREE(next, sizeof(node_t));
 	    /* Inserting */
 	    addr2 = val2 % maxhtlength;
-	    prev = (node_t *)TX_LOAD(&set->buckets[addr2]->head);
+	    prev = (node_t *)TX_LOAD(&set->buckets[addr2].set.head);
 	    next = (node_t *)TX_LOAD(&prev->next);
 	    while(1) {
 	      v = TX_LOAD(&next->val);
@@ -175,9 +175,9 @@ int ht_move(ht_intset_t *set, int val1, int val2, int transactional) {
 	addr1 = val1 % maxhtlength;
 	addr2 = val2 % maxhtlength;
 
-	if (set_remove(set->buckets[addr1], val1, 0)) 
+	if (set_remove(&set->buckets[addr1].set, val1, 0)) 
 	  result = 1;
-	set_seq_add(set->buckets[addr2], val2, 0);
+	set_seq_add(&set->buckets[addr2].set, val2, 0);
 	return result;
 
 #elif defined STM
@@ -190,7 +190,7 @@ int ht_move(ht_intset_t *set, int val1, int val2, int transactional) {
 	  TX_START(EL);
 	  result = 0;
 	  addr1 = val1 % maxhtlength;
-	  prev = (node_t *)TX_LOAD(&set->buckets[addr1]->head);
+	  prev = (node_t *)TX_LOAD(&set->buckets[addr1].set.head);
 	  next = (node_t *)TX_LOAD(&prev->next);
 	  while(1) {
 	    v = TX_LOAD(&next->val);
@@ -203,7 +203,7 @@ int ht_move(ht_intset_t *set, int val1, int val2, int transactional) {
 	  if (v == val1) {
 	    /* Inserting */
 	    addr2 = val2 % maxhtlength;
-	    prev = (node_t *)TX_LOAD(&set->buckets[addr2]->head);
+	    prev = (node_t *)TX_LOAD(&set->buckets[addr2].set.head);
 	    next = (node_t *)TX_LOAD(&prev->next);
 	    while(1) {
 	      v = TX_LOAD(&next->val);
@@ -229,7 +229,7 @@ int ht_move(ht_intset_t *set, int val1, int val2, int transactional) {
 	  TX_START(NL);
 	  result = 0;
 	  addr1 = val1 % maxhtlength;
-	  prev = (node_t *)TX_LOAD(&set->buckets[addr1]->head);
+	  prev = (node_t *)TX_LOAD(&set->buckets[addr1].set.head);
 	  next = (node_t *)TX_LOAD(&prev->next);
 	  while(1) {
 	    v = TX_LOAD(&next->val);
@@ -242,7 +242,7 @@ int ht_move(ht_intset_t *set, int val1, int val2, int transactional) {
 	  if (v == val1) {
 	    /* Inserting */
 	    addr2 = val2 % maxhtlength;
-	    prev = (node_t *)TX_LOAD(&set->buckets[addr2]->head);
+	    prev = (node_t *)TX_LOAD(&set->buckets[addr2].set.head);
 	    next = (node_t *)TX_LOAD(&prev->next);
 	    while(1) {
 	      v = TX_LOAD(&next->val);
@@ -288,8 +288,8 @@ int ht_move_orrollback(ht_intset_t *set, int val1, int val2, int transactional)
 	int addr1, addr2;		
 	addr1 = val1 % maxhtlength;
 	addr2 = val2 % maxhtlength;
-	result =  (set_remove(set->buckets[addr1], val1, transactional) &&
-			   set_add(set->buckets[addr2], val2, transactional));
+	result =  (set_remove(&set->buckets[addr1].set, val1, transactional) &&
+			   set_add(&set->buckets[addr2].set, val2, transactional));
 	
 #elif defined STM
 
@@ -301,7 +301,7 @@ int ht_move_orrollback(ht_intset_t *set, int val1, int val2, int transactional)
 	  TX_START(EL);
 	  result = 0;
 	  addr1 = val1 % maxhtlength;
-	  prev = (node_t *)TX_LOAD(&set->buckets[addr1]->head);
+	  prev = (node_t *)TX_LOAD(&set->buckets[addr1].set.head);
 	  next = (node_t *)TX_LOAD(&prev->next);
 	  while(1) {
 	    v = TX_LOAD(&next->val);
@@ -317,7 +317,7 @@ int ht_move_orrollback(ht_intset_t *set, int val1, int val2, int transactional)
 	    TX_STORE(&prev->next, n);
 	    /* Inserting */
 	    addr2 = val2 % maxhtlength;
-	    prev = (node_t *)TX_LOAD(&set->buckets[addr2]->head);
+	    prev = (node_t *)TX_LOAD(&set->buckets[addr2].set.head);
 	    next = (node_t *)TX_LOAD(&prev->next);
 	    while(1) {
 	      v = TX_LOAD(&next->val);
@@ -342,7 +342,7 @@ int ht_move_orrollback(ht_intset_t *set, int val1, int val2, int transactional)
 	  TX_START(NL);
 	  result = 0;
 	  addr1 = val1 % maxhtlength;
-	  prev = (node_t *)TX_LOAD(&set->buckets[addr1]->head);
+	  prev = (node_t *)TX_LOAD(&set->buckets[addr1].set.head);
 	  next = (node_t *)TX_LOAD(&prev->next);
 	  while(1) {
 	    v = TX_LOAD(&next->val);
@@ -358,7 +358,7 @@ int ht_move_orrollback(ht_intset_t *set, int val1, int val2, int transactional)
 	    TX_STORE(&prev->next, n);
 	    /* Inserting */
 	    addr2 = val2 % maxhtlength;
-	    prev = (node_t *)TX_LOAD(&set->buckets[addr2]->head);
+	    prev = (node_t *)TX_LOAD(&set->buckets[addr2].set.head);
 	    next = (node_t *)TX_LOAD(&prev->next);
 	    while(1) {
 	      v = TX_LOAD(&next->val);
@@ -407,7 +407,7 @@ int ht_snapshot(ht_intset_t *set, int transactional) {
 	node_t *next;
 	
 	for (i=0; i < maxhtlength; i++) {
-		next = set->buckets[i]->head->next;
+		next = set->buckets[i].set.head->next;
 		while(next->next) {
 			sum += next->val;
 			next = next->next;
@@ -424,7 +424,7 @@ int ht_snapshot(ht_intset_t *set, int transactional) {
 	TX_START(NL);
 	result = 0;
 	for (i=0; i < maxhtlength; i++) {
-		next = (node_t *)TX_LOAD(&set->buckets[i]->head->next);
+		next = (node_t *)TX_LOAD(&set->buckets[i].set.head->next);
 		while(next->next) {
 			sum += TX_LOAD(&next->val);
 			next = (node_t *)TX_LOAD(&next->next);
@@ -0,0 +1,81 @@
+/*
+ * File:
+ *   open-addressing.h
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Locks and hash function shared by the hashtables that store their
+ *   keys in the table itself (Swiss, cuckoo and hopscotch).
+ *
+ * Copyright (c) 2026.
+ *
+ * open-addressing.h is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef OPEN_ADDRESSING_H
+#define OPEN_ADDRESSING_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "bench.h"
+
+#ifdef MUTEX
+typedef pthread_mutex_t ptlock_t;
+#  define INIT_LOCK(lock)		pthread_mutex_init((pthread_mutex_t *) lock, NULL);
+#  define DESTROY_LOCK(lock)		pthread_mutex_destroy((pthread_mutex_t *) lock)
+#  define LOCK(lock)			bench_locked(pthread_mutex_lock((pthread_mutex_t *) lock))
+#  define TRYLOCK(lock)			pthread_mutex_trylock((pthread_mutex_t *) lock)
+#  define UNLOCK(lock)			pthread_mutex_unlock((pthread_mutex_t *) lock)
+#else
+typedef pthread_spinlock_t ptlock_t;
+#  define INIT_LOCK(lock)		pthread_spin_init((pthread_spinlock_t *) lock, PTHREAD_PROCESS_PRIVATE);
+#  define DESTROY_LOCK(lock)		pthread_spin_destroy((pthread_spinlock_t *) lock)
+#  define LOCK(lock)			bench_locked(pthread_spin_lock((pthread_spinlock_t *) lock))
+#  define TRYLOCK(lock)			pthread_spin_trylock((pthread_spinlock_t *) lock)
+#  define UNLOCK(lock)			pthread_spin_unlock((pthread_spinlock_t *) lock)
+#endif
+
+#define OA_MAX_GROWTH_KEYS              (1L << 26)
+
+/* Finalizer of MurmurHash3, keys are often small consecutive integers */
+static inline uint64_t oa_hash(intptr_t val) {
+	uint64_t h = (uint64_t)val;
+
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+/*
+ * Keys a table, which does not grow, must have room for: the initial
+ * ones and one per thread, as each may add a key before it removes one,
+ * or the whole range if adds may outnumber removes (-g).
+ */
+static inline long oa_capacity(const bench_config_t *cfg) {
+	if (cfg->growth == 0)
+		return (long)cfg->initial + cfg->nb_threads;
+	if (cfg->range > OA_MAX_GROWTH_KEYS) {
+		printf("ERROR: Growth (-g) needs a range (-r) of at most %ld keys\n",
+		       OA_MAX_GROWTH_KEYS);
+		exit(1);
+	}
+	return cfg->range;
+}
+
+#endif
@@ -0,0 +1,241 @@
+/*
+ * File:
+ *   split-ordered.c
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Resizable lock-free hashtable of Shalev and Shavit
+ *   "Split-Ordered Lists: Lock-Free Extensible Hash Tables"
+ *   O. Shalev, N. Shavit, J. ACM 53(3), p. 379-405, 2006.
+ *   Keys are never moved: the table doubles by splitting each bucket in
+ *   two at a point of the list where a new sentinel is lazily inserted.
+ *
+ * Copyright (c) 2026.
+ *
+ * split-ordered.c is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <string.h>
+
+#include "split-ordered.h"
+
+/*
+ * The split order of a key is its bit-reversed value: keys of bucket b
+ * of a table of 2^i buckets share their i low-order bits, which become
+ * the high-order bits of their order, and bucket b + 2^i gets the second
+ * half of them when the table doubles. The order of a key has its low
+ * bit set, that of a sentinel does not, so that the sentinel of a bucket
+ * precedes its keys.
+ */
+static inline val_t so_reverse(unsigned long w) {
+	unsigned int v = (unsigned int)w;
+
+	v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+	v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+	v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
+	v = ((v >> 8) & 0x00FF00FF) | ((v & 0x00FF00FF) << 8);
+	v = (v >> 16) | (v << 16);
+	return (val_t)v;
+}
+
+static inline val_t so_regular(val_t key) {
+	return so_reverse((unsigned long)key) | 1;
+}
+
+static inline val_t so_dummy(unsigned long bucket) {
+	return so_reverse(bucket);
+}
+
+/*
+ * so_search runs harris_search on the part of the list that starts at
+ * the sentinel start, the keys of its bucket follow it.
+ */
+static inline node_t *so_search(node_t *start, val_t val, node_t **left_node) {
+	intset_t bucket;
+
+	bucket.head = start;
+	*left_node = start;
+	return harris_search(&bucket, val, left_node);
+}
+
+/*
+ * so_insert inserts a node of order val after start, as harris_insert
+ * does, but returns the node of order val whether it was inserted or
+ * already present, and sets added accordingly.
+ */
+static node_t *so_insert(node_t *start, val_t val, int *added) {
+	node_t *newnode = NULL, *right_node, *left_node;
+
+	do {
+		right_node = so_search(start, val, &left_node);
+		if (right_node->next && right_node->val == val) {
+			if (newnode != NULL)
+				free(newnode);
+			*added = 0;
+			return right_node;
+		}
+		if (newnode == NULL)
+			newnode = new_node(val, right_node, 0);
+		else
+			newnode->next = right_node;
+		/* mem-bar between node creation and insertion */
+		AO_nop_full();
+		if (ATOMIC_CAS_MB(&left_node->next, right_node, newnode)) {
+			*added = 1;
+			return newnode;
+		}
+	} while (1);
+}
+
+/* Returns the slot of a bucket, allocating its segment if needed */
+static node_t **so_slot(so_ht_t *h, unsigned long bucket) {
+	unsigned long i = bucket >> SO_SEGMENT_BITS;
+	node_t **seg = h->segments[i], **newseg;
+
+	if (seg == NULL) {
+		if ((newseg = (node_t **)calloc(SO_SEGMENT_SIZE, sizeof(node_t *))) == NULL) {
+			perror("calloc");
+			exit(1);
+		}
+		if (ATOMIC_CAS_MB(&h->segments[i], NULL, newseg)) {
+			AO_fetch_and_add1_full(&h->nb_segments);
+			seg = newseg;
+		} else {
+			free(newseg);
+			seg = h->segments[i];
+		}
+	}
+	return &seg[bucket & (SO_SEGMENT_SIZE - 1)];
+}
+
+/*
+ * Returns the sentinel of a bucket, initializing the bucket first if it
+ * was never reached: its sentinel goes after the one of its parent, the
+ * bucket it was split from, initialized recursively. Concurrent threads
+ * initializing the same bucket find the same sentinel.
+ */
+static node_t *so_bucket(so_ht_t *h, unsigned long bucket) {
+	node_t **slot = so_slot(h, bucket);
+	node_t *sentinel = *slot;
+	unsigned long msb;
+	int added;
+
+	if (sentinel == NULL) {
+		for (msb = bucket; msb & (msb - 1); msb &= msb - 1)
+			;
+		sentinel = so_insert(so_bucket(h, bucket & ~msb), so_dummy(bucket), &added);
+		if (added)
+			AO_fetch_and_add1_full(&h->nb_buckets);
+		*slot = sentinel;
+	}
+	return sentinel;
+}
+
+int so_contains(so_ht_t *h, val_t key) {
+	node_t *right_node, *left_node;
+	val_t val = so_regular(key);
+
+	right_node = so_search(so_bucket(h, key & (h->size - 1)), val, &left_node);
+	return right_node->next && right_node->val == val;
+}
+
+/*
+ * so_add counts the keys and doubles the number of buckets once there
+ * are more than load per bucket. Doubling is a single CAS, the new
+ * buckets are initialized by the operations that need them.
+ */
+int so_add(so_ht_t *h, val_t key) {
+	unsigned long size = h->size;
+	int added;
+
+	so_insert(so_bucket(h, key & (size - 1)), so_regular(key), &added);
+	if (!added)
+		return 0;
+	if (AO_fetch_and_add1_full(&h->count) + 1 > size * h->load &&
+	    size < SO_MAX_BUCKETS)
+		ATOMIC_CAS_MB(&h->size, size, size << 1);
+	return 1;
+}
+
+/* Same as harris_delete, the table never shrinks */
+int so_remove(so_ht_t *h, val_t key) {
+	node_t *start, *right_node, *right_node_next, *left_node;
+	val_t val = so_regular(key);
+
+	start = so_bucket(h, key & (h->size - 1));
+	do {
+		right_node = so_search(start, val, &left_node);
+		if (!right_node->next || right_node->val != val)
+			return 0;
+		right_node_next = right_node->next;
+		if (!is_marked_ref((long) right_node_next))
+			if (ATOMIC_CAS_MB(&right_node->next,
+					  right_node_next,
+					  get_marked_ref((long) right_node_next)))
+				break;
+	} while (1);
+	if (!ATOMIC_CAS_MB(&left_node->next, right_node, right_node_next))
+		so_search(start, val, &left_node);
+	AO_fetch_and_sub1_full(&h->count);
+	return 1;
+}
+
+/* Counts the keys that are not logically deleted, when quiescent */
+long so_size(so_ht_t *h) {
+	long size = 0;
+	node_t *node;
+
+	node = (node_t *)get_unmarked_ref((long) h->list.head->next);
+	while (node->next != NULL) {
+		if ((node->val & 1) && !is_marked_ref((long) node->next))
+			size++;
+		node = (node_t *)get_unmarked_ref((long) node->next);
+	}
+	return size;
+}
+
+so_ht_t *so_new(unsigned long size, unsigned int load) {
+	so_ht_t *h;
+	node_t *max;
+
+	if ((h = (so_ht_t *)malloc(sizeof(so_ht_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	memset(h, 0, sizeof(so_ht_t));
+	max = new_node(VAL_MAX, NULL, 0);
+	h->list.head = new_node(VAL_MIN, max, 0);
+	h->load = load;
+	for (h->size = 1; h->size < size && h->size < SO_MAX_BUCKETS; h->size <<= 1)
+		;
+	/* The head of the list is the sentinel of bucket 0 */
+	*so_slot(h, 0) = h->list.head;
+	h->nb_buckets = 1;
+	return h;
+}
+
+void so_delete(so_ht_t *h) {
+	node_t *node, *next;
+	int i;
+
+	node = h->list.head;
+	while (node != NULL) {
+		next = (node_t *)get_unmarked_ref((long) node->next);
+		free(node);
+		node = next;
+	}
+	for (i = 0; i < SO_MAX_SEGMENTS; i++)
+		if (h->segments[i] != NULL)
+			free(h->segments[i]);
+	free(h);
+}
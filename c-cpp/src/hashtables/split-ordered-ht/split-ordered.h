@@ -0,0 +1,66 @@
+/*
+ * File:
+ *   split-ordered.h
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Resizable lock-free hashtable of Shalev and Shavit
+ *   "Split-Ordered Lists: Lock-Free Extensible Hash Tables"
+ *   O. Shalev, N. Shavit, J. ACM 53(3), p. 379-405, 2006.
+ *
+ * Copyright (c) 2026.
+ *
+ * split-ordered.h is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "../../linkedlists/lockfree-list/harris.h"
+
+#define DEFAULT_LOAD                    1
+#define DEFAULT_ELASTICITY              4
+
+/*
+ * The bucket directory is a table of segments, each of SO_SEGMENT_SIZE
+ * bucket pointers allocated on first use, so that doubling the table
+ * never moves a bucket.
+ */
+#define SO_SEGMENT_BITS                 10
+#define SO_SEGMENT_SIZE                 (1 << SO_SEGMENT_BITS)
+#define SO_MAX_SEGMENTS                 (1 << 14)
+#define SO_MAX_BUCKETS                  ((unsigned long)SO_SEGMENT_SIZE * SO_MAX_SEGMENTS)
+
+/* Keys are reversed on 32 bits, the top one is reserved to the order */
+#define SO_MAX_KEY                      0x7FFFFFFFL
+
+/*
+ * All keys are kept in a single Harris list sorted by their bit-reversed
+ * value, with a sentinel node starting each bucket. The head of the list
+ * is the sentinel of bucket 0. Buckets are initialized by the first
+ * operation that reaches them, by inserting their sentinel after the
+ * one of their parent bucket.
+ */
+typedef struct so_ht {
+	intset_t list;
+	node_t **volatile segments[SO_MAX_SEGMENTS];
+	volatile AO_t size;		/* # of buckets, a power of 2 */
+	volatile AO_t count;		/* # of keys */
+	volatile AO_t nb_buckets;	/* # of initialized buckets */
+	volatile AO_t nb_segments;	/* # of allocated segments */
+	unsigned int load;		/* mean keys per bucket before doubling */
+} so_ht_t;
+
+so_ht_t *so_new(unsigned long size, unsigned int load);
+void so_delete(so_ht_t *h);
+long so_size(so_ht_t *h);
+int so_contains(so_ht_t *h, val_t key);
+int so_add(so_ht_t *h, val_t key);
+int so_remove(so_ht_t *h, val_t key);
@@ -0,0 +1,127 @@
+/*
+ * File:
+ *   test.c
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Concurrent accesses of a split-ordered hashtable
+ *
+ * Copyright (c) 2026.
+ *
+ * test.c is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "split-ordered.h"
+#include "bench.h"
+
+static int load_factor = DEFAULT_LOAD;
+
+static const bench_option_t so_options[] = {
+	{'l', "load-factor", "Ratio of keys over buckets before doubling", &load_factor},
+	{0, NULL, NULL, NULL}
+};
+
+/* Starts with as many buckets as the fixed-size hashtable would have */
+static void *so_init(const bench_config_t *cfg)
+{
+	if (load_factor <= 0) {
+		printf("ERROR: Load factor (-l) must be positive\n");
+		exit(1);
+	}
+	if (cfg->range > SO_MAX_KEY) {
+		printf("ERROR: Range (-r) must be at most %ld, keys are reversed on 32 bits\n",
+		       SO_MAX_KEY);
+		exit(1);
+	}
+
+	return so_new((unsigned long)cfg->initial / load_factor, load_factor);
+}
+
+static void so_populated(void *set, const bench_config_t *cfg)
+{
+	printf("Bucket amount: %lu\n", (unsigned long)((so_ht_t *)set)->size);
+}
+
+static void so_finish(void *set)
+{
+	so_ht_t *h = (so_ht_t *)set;
+
+	printf("Bucket amount: %lu (%lu initialized)\n",
+	       (unsigned long)h->size, (unsigned long)h->nb_buckets);
+}
+
+static void so_destroy(void *set)
+{
+	so_delete((so_ht_t *)set);
+}
+
+static int so_bench_add(void *set, skey_t key, thread_data_t *d)
+{
+	return so_add((so_ht_t *)set, key);
+}
+
+static int so_bench_remove(void *set, skey_t key, thread_data_t *d)
+{
+	return so_remove((so_ht_t *)set, key);
+}
+
+static int so_bench_contains(void *set, skey_t key, thread_data_t *d)
+{
+	return so_contains((so_ht_t *)set, key);
+}
+
+static long so_bench_size(void *set)
+{
+	return so_size((so_ht_t *)set);
+}
+
+/* Unlinked nodes are never freed, as in Harris' list */
+static void so_memory(void *set, const thread_data_t *data, int nb_threads, bench_mem_t *m)
+{
+	so_ht_t *h = (so_ht_t *)set;
+	int i;
+
+	for (i = 0; i < nb_threads; i++)
+		m->retired += data[i].nb_removed;
+	m->nodes = so_size(h);
+	m->index_nodes = (long)h->nb_buckets + 1;
+	m->bytes = sizeof(so_ht_t) +
+		(long)h->nb_segments * SO_SEGMENT_SIZE * sizeof(node_t *) +
+		(m->nodes + m->index_nodes) * sizeof(node_t);
+	m->retired_bytes = m->retired * sizeof(node_t);
+}
+
+static const bench_ops_t so_ops = {
+	"split-ordered lock-free hash table",
+	so_init,
+	so_populated,
+	so_finish,
+	so_destroy,
+	NULL,
+	NULL,
+	so_bench_add,
+	so_bench_remove,
+	so_bench_contains,
+	so_bench_size,
+	NULL,
+	NULL,
+	so_options,
+	DEFAULT_ELASTICITY,
+	NULL,
+	so_memory
+};
+
+int main(int argc, char **argv)
+{
+	return bench_main(argc, argv, &so_ops);
+}
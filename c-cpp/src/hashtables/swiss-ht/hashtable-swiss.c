@@ -0,0 +1,326 @@
+/*
+ * File:
+ *   hashtable-swiss.c
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Concurrent open-addressing hashtable in the style of Swiss tables.
+ *   Keys are stored inline in groups of 16 slots, so that a lookup
+ *   compares the 7-bit tag of its hash against a whole group at once
+ *   rather than chasing one pointer per key. Lookups take no lock and
+ *   validate each group against its sequence number, updates lock the
+ *   home group of their key and the group they write to.
+ *
+ * Copyright (c) 2026.
+ *
+ * hashtable-swiss.c is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <sched.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "hashtable-swiss.h"
+
+#define SW_TAG(h)                       ((uint8_t)((h) & 0x7F))
+#define SW_HOME(set, h)                 (((h) >> 7) & (set)->mask)
+
+/*
+ * Groups are visited at triangular offsets from the home group, which
+ * reaches every group once as their number is a power of 2.
+ */
+#define SW_NEXT(set, pos, i)            (((pos) + (i)) & (set)->mask)
+
+/* Bit i of the result is set if control byte i is c */
+static inline unsigned int sw_match(const uint8_t *ctrl, uint8_t c) {
+#ifdef __SSE2__
+	__m128i g = _mm_load_si128((const __m128i *)ctrl);
+
+	return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)c)));
+#else
+	unsigned int m = 0;
+	int i;
+
+	for (i = 0; i < SW_GROUP_SIZE; i++)
+		if (ctrl[i] == c)
+			m |= 1U << i;
+	return m;
+#endif
+}
+
+/* Bit i of the result is set if slot i is empty or a tombstone */
+static inline unsigned int sw_match_free(const uint8_t *ctrl) {
+#ifdef __SSE2__
+	return (unsigned int)_mm_movemask_epi8(_mm_load_si128((const __m128i *)ctrl));
+#else
+	unsigned int m = 0;
+	int i;
+
+	for (i = 0; i < SW_GROUP_SIZE; i++)
+		if (ctrl[i] & 0x80)
+			m |= 1U << i;
+	return m;
+#endif
+}
+
+/* Only the holder of the group lock changes its slots */
+static inline void sw_write_begin(sw_group_t *g) {
+	g->seq++;
+	AO_nop_full();
+}
+
+static inline void sw_write_end(sw_group_t *g) {
+	AO_nop_full();
+	g->seq++;
+}
+
+/*
+ * Looks val up in a group, retrying while a writer changes it: returns
+ * whether it is there, with its slot, and whether the group has an
+ * empty slot, in which case val cannot be further along.
+ */
+static int sw_group_find(sw_group_t *g, val_t val, uint8_t tag, int *slot, int *empty) {
+	AO_t seq;
+	unsigned int m;
+	int found;
+
+	do {
+		while ((seq = AO_load_acquire(&g->seq)) & 1)
+			;
+		found = 0;
+		for (m = sw_match(g->ctrl, tag); m != 0; m &= m - 1) {
+			if (g->keys[__builtin_ctz(m)] == val) {
+				*slot = __builtin_ctz(m);
+				found = 1;
+				break;
+			}
+		}
+		*empty = (sw_match(g->ctrl, SW_EMPTY) != 0);
+		AO_nop_full();
+	} while (AO_load(&g->seq) != seq);
+	return found;
+}
+
+/*
+ * Returns the position of val along its probe sequence, and its group
+ * and slot, or -1 if it is absent.
+ */
+static long sw_lookup(ht_intset_t *set, val_t val, uint64_t h, sw_group_t **group, int *slot) {
+	unsigned long i, pos = SW_HOME(set, h);
+	int empty;
+
+	for (i = 0; i <= set->mask; pos = SW_NEXT(set, pos, ++i)) {
+		if (sw_group_find(&set->groups[pos], val, SW_TAG(h), slot, &empty)) {
+			*group = &set->groups[pos];
+			return (long)i;
+		}
+		if (empty)
+			break;
+	}
+	return -1;
+}
+
+/* Forgets the first n groups of a probe sequence were passed */
+static void sw_unpass(ht_intset_t *set, unsigned long home, unsigned long n) {
+	unsigned long i, pos = home;
+
+	for (i = 0; i < n; pos = SW_NEXT(set, pos, ++i))
+		AO_fetch_and_sub1_full(&set->groups[pos].overflow);
+}
+
+int ht_contains(ht_intset_t *set, val_t val, int transactional) {
+	sw_group_t *g;
+	int slot;
+
+	return sw_lookup(set, val, oa_hash(val), &g, &slot) >= 0;
+}
+
+/*
+ * Stores val in the first free slot of its probe sequence. Each group
+ * counts it as passed before it is checked, so that no tombstone of a
+ * group it passes may become empty while it is stored beyond. Other
+ * groups than the home one are only tried, not to deadlock with the
+ * updates they are the home group of.
+ */
+int ht_add(ht_intset_t *set, val_t val, int transactional) {
+	uint64_t h = oa_hash(val);
+	unsigned long i, pos, home = SW_HOME(set, h);
+	sw_group_t *g, *hg = &set->groups[home];
+	unsigned int avail;
+	int slot;
+
+ retry:
+	LOCK(&hg->lock);
+	if (sw_lookup(set, val, h, &g, &slot) >= 0) {
+		UNLOCK(&hg->lock);
+		return 0;
+	}
+	for (i = 0, pos = home; i <= set->mask; pos = SW_NEXT(set, pos, ++i)) {
+		g = &set->groups[pos];
+		AO_fetch_and_add1_full(&g->overflow);
+		if (sw_match_free(g->ctrl) == 0)
+			continue;
+		if (g != hg) {
+			if (TRYLOCK(&g->lock) != 0) {
+				sw_unpass(set, home, i + 1);
+				UNLOCK(&hg->lock);
+				sched_yield();
+				goto retry;
+			}
+			bench_preempt();
+		}
+		avail = sw_match_free(g->ctrl);
+		if (avail != 0) {
+			slot = __builtin_ctz(avail);
+			sw_write_begin(g);
+			g->keys[slot] = val;
+			g->ctrl[slot] = SW_TAG(h);
+			sw_write_end(g);
+			AO_fetch_and_sub1_full(&g->overflow);
+		}
+		if (g != hg)
+			UNLOCK(&g->lock);
+		if (avail != 0) {
+			UNLOCK(&hg->lock);
+			return 1;
+		}
+	}
+	printf("ERROR: hashtable full, lower the load factor (-l)\n");
+	exit(1);
+}
+
+/*
+ * Leaves a tombstone in the slot of val, or empties it if no key was
+ * stored past its group. The tombstone is written before the group
+ * count is read, as adds count themselves before they read the slots.
+ */
+int ht_remove(ht_intset_t *set, val_t val, int transactional) {
+	uint64_t h = oa_hash(val);
+	unsigned long home = SW_HOME(set, h);
+	sw_group_t *g, *hg = &set->groups[home];
+	long i;
+	int slot;
+
+ retry:
+	LOCK(&hg->lock);
+	if ((i = sw_lookup(set, val, h, &g, &slot)) < 0) {
+		UNLOCK(&hg->lock);
+		return 0;
+	}
+	if (g != hg) {
+		if (TRYLOCK(&g->lock) != 0) {
+			UNLOCK(&hg->lock);
+			sched_yield();
+			goto retry;
+		}
+		bench_preempt();
+	}
+	sw_write_begin(g);
+	g->ctrl[slot] = SW_DELETED;
+	sw_write_end(g);
+	AO_nop_full();
+	if (AO_load(&g->overflow) == 0) {
+		sw_write_begin(g);
+		g->ctrl[slot] = SW_EMPTY;
+		sw_write_end(g);
+	}
+	if (g != hg)
+		UNLOCK(&g->lock);
+	sw_unpass(set, home, (unsigned long)i);
+	UNLOCK(&hg->lock);
+	return 1;
+}
+
+/*
+ * Empties the tombstones of the groups that no key is stored past
+ * anymore, so that lookups stop there again instead of probing on.
+ */
+void ht_cleanup(ht_intset_t *set) {
+	unsigned long pos;
+	unsigned int m;
+	sw_group_t *g;
+
+	for (pos = 0; pos <= set->mask; pos++) {
+		g = &set->groups[pos];
+		if (AO_load(&g->overflow) != 0 || sw_match(g->ctrl, SW_DELETED) == 0)
+			continue;
+		LOCK(&g->lock);
+		m = sw_match(g->ctrl, SW_DELETED);
+		AO_nop_full();
+		if (m != 0 && AO_load(&g->overflow) == 0) {
+			sw_write_begin(g);
+			for (; m != 0; m &= m - 1) {
+				g->ctrl[__builtin_ctz(m)] = SW_EMPTY;
+				AO_fetch_and_add1(&set->tombstones);
+			}
+			sw_write_end(g);
+		}
+		UNLOCK(&g->lock);
+	}
+	AO_fetch_and_add1(&set->sweeps);
+}
+
+long ht_size(ht_intset_t *set) {
+	long size = 0;
+	unsigned long pos;
+
+	for (pos = 0; pos <= set->mask; pos++)
+		size += SW_GROUP_SIZE - __builtin_popcount(sw_match_free(set->groups[pos].ctrl));
+	return size;
+}
+
+long ht_tombstones(ht_intset_t *set) {
+	long n = 0;
+	unsigned long pos;
+
+	for (pos = 0; pos <= set->mask; pos++)
+		n += __builtin_popcount(sw_match(set->groups[pos].ctrl, SW_DELETED));
+	return n;
+}
+
+/* Enough groups of 16 slots for capacity keys, a power of 2 */
+ht_intset_t *ht_new(long capacity) {
+	ht_intset_t *set;
+	unsigned long n, i;
+
+	for (n = 1; n * SW_GROUP_SIZE < (unsigned long)capacity; n <<= 1)
+		;
+	if ((set = (ht_intset_t *)malloc(sizeof(ht_intset_t))) == NULL) {
+		perror("malloc");
+		exit(1);
+	}
+	if (posix_memalign((void **)&set->groups, 64, n * sizeof(sw_group_t)) != 0) {
+		perror("posix_memalign");
+		exit(1);
+	}
+	memset(set->groups, 0, n * sizeof(sw_group_t));
+	for (i = 0; i < n; i++) {
+		memset(set->groups[i].ctrl, SW_EMPTY, SW_GROUP_SIZE);
+		INIT_LOCK(&set->groups[i].lock);
+	}
+	set->mask = n - 1;
+	set->tombstones = 0;
+	set->sweeps = 0;
+	return set;
+}
+
+void ht_delete(ht_intset_t *set) {
+	unsigned long i;
+
+	for (i = 0; i <= set->mask; i++)
+		DESTROY_LOCK(&set->groups[i].lock);
+	free(set->groups);
+	free(set);
+}
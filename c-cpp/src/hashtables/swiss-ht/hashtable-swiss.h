@@ -0,0 +1,82 @@
+/*
+ * File:
+ *   hashtable-swiss.h
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Open-addressing hashtable in the style of Swiss tables: slots come
+ *   in groups of 16 with one control byte each, probed all at once.
+ *
+ * Copyright (c) 2026.
+ *
+ * hashtable-swiss.h is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include <atomic_ops.h>
+
+#include "bench.h"
+#include "../open-addressing.h"
+
+#define DEFAULT_LOAD                    50
+#define SW_MAX_LOAD                     95	/* %, unlocked probes may miss the last free slots */
+#define DEFAULT_CLEANUP                 1000
+
+#define SW_GROUP_SIZE                   16
+
+/*
+ * Control bytes: the 7 low-order bits of the hash of the key of a full
+ * slot, or one of the two values below, which have the high bit set.
+ */
+#define SW_EMPTY                        ((uint8_t)0x80)
+#define SW_DELETED                      ((uint8_t)0xFE)
+
+typedef intptr_t val_t;
+
+/*
+ * A group is a seqlock: writers take the lock and make seq odd while
+ * they change a slot, readers take no lock and retry if seq moved.
+ * Updates of a key are serialized by the lock of its home group, the
+ * first of its probe sequence. overflow counts the keys stored past
+ * the group in their probe sequence: a removed slot becomes a
+ * tombstone while it is not 0, so that their lookups go on probing.
+ */
+typedef struct sw_group {
+	uint8_t ctrl[SW_GROUP_SIZE];
+	volatile AO_t seq;
+	volatile AO_t overflow;
+	ptlock_t lock;
+	val_t keys[SW_GROUP_SIZE];
+} __attribute__((aligned(64))) sw_group_t;
+
+typedef struct ht_intset {
+	sw_group_t *groups;
+	unsigned long mask;		/* # of groups - 1 */
+	volatile AO_t tombstones;	/* cleared by the background thread */
+	volatile AO_t sweeps;
+} ht_intset_t;
+
+ht_intset_t *ht_new(long capacity);
+void ht_delete(ht_intset_t *set);
+long ht_size(ht_intset_t *set);
+long ht_tombstones(ht_intset_t *set);
+int ht_contains(ht_intset_t *set, val_t val, int transactional);
+int ht_add(ht_intset_t *set, val_t val, int transactional);
+int ht_remove(ht_intset_t *set, val_t val, int transactional);
+void ht_cleanup(ht_intset_t *set);
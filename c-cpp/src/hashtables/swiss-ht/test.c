@@ -0,0 +1,158 @@
+/*
+ * File:
+ *   test.c
+ * Author(s):
+ *   agent <agent@local>
+ * Description:
+ *   Concurrent accesses of an open-addressing hashtable
+ *
+ * Copyright (c) 2026.
+ *
+ * test.c is part of Synchrobench
+ *
+ * Synchrobench is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <unistd.h>
+
+#include "hashtable-swiss.h"
+
+#define TRANSACTIONAL                   d->unit_tx
+
+static int load_factor = DEFAULT_LOAD;
+static int cleanup_us = DEFAULT_CLEANUP;
+
+static const bench_option_t ht_options[] = {
+	{'l', "load-factor", "Percentage of the slots the initial keys fill", &load_factor},
+	{'z', "cleanup-interval", "Microseconds between tombstone sweeps (0=no sweep)", &cleanup_us},
+	{0, NULL, NULL, NULL}
+};
+
+/* Background thread emptying tombstones */
+static pthread_t cleaner;
+static volatile int cleaner_stop;
+static int cleaner_running;
+
+static void *cleaner_loop(void *set)
+{
+	bench_pin_background();
+
+	while (!cleaner_stop) {
+		usleep(cleanup_us);
+		ht_cleanup((ht_intset_t *)set);
+	}
+	return NULL;
+}
+
+static void *ht_init(const bench_config_t *cfg)
+{
+	if (load_factor <= 0 || load_factor > SW_MAX_LOAD) {
+		printf("ERROR: Load factor (-l) must be within 1 and %d\n", SW_MAX_LOAD);
+		exit(1);
+	}
+	assert(cleanup_us >= 0);
+
+	return ht_new(oa_capacity(cfg) * 100 / load_factor);
+}
+
+static void ht_populated(void *set, const bench_config_t *cfg)
+{
+	ht_intset_t *h = (ht_intset_t *)set;
+
+	printf("Group amount : %lu (%lu slots)\n", h->mask + 1,
+	       (h->mask + 1) * SW_GROUP_SIZE);
+	if (cleanup_us > 0) {
+		cleaner_stop = 0;
+		if (pthread_create(&cleaner, NULL, cleaner_loop, set) != 0) {
+			perror("pthread_create");
+			exit(1);
+		}
+		cleaner_running = 1;
+	}
+}
+
+static void ht_finish(void *set)
+{
+	ht_intset_t *h = (ht_intset_t *)set;
+
+	if (cleaner_running) {
+		cleaner_stop = 1;
+		pthread_join(cleaner, NULL);
+		cleaner_running = 0;
+	}
+	printf("Tombstones   : %ld left, %lu emptied in %lu sweeps\n",
+	       ht_tombstones(h), (unsigned long)h->tombstones,
+	       (unsigned long)h->sweeps);
+}
+
+static void ht_destroy(void *set)
+{
+	ht_delete((ht_intset_t *)set);
+}
+
+static int ht_bench_add(void *set, skey_t key, thread_data_t *d)
+{
+	return ht_add((ht_intset_t *)set, key, TRANSACTIONAL);
+}
+
+static int ht_bench_remove(void *set, skey_t key, thread_data_t *d)
+{
+	return ht_remove((ht_intset_t *)set, key, TRANSACTIONAL);
+}
+
+static int ht_bench_contains(void *set, skey_t key, thread_data_t *d)
+{
+	return ht_contains((ht_intset_t *)set, key, TRANSACTIONAL);
+}
+
+static long ht_bench_size(void *set)
+{
+	return ht_size((ht_intset_t *)set);
+}
+
+/* Keys are stored in the groups, which are all allocated upfront */
+static void ht_memory(void *set, const thread_data_t *data, int nb_threads, bench_mem_t *m)
+{
+	ht_intset_t *h = (ht_intset_t *)set;
+
+	m->nodes = ht_size(h);
+	m->bytes = sizeof(ht_intset_t) + (h->mask + 1) * sizeof(sw_group_t);
+}
+
+static const bench_ops_t ht_ops = {
+	"open-addressing hash table",
+	ht_init,
+	ht_populated,
+	ht_finish,
+	ht_destroy,
+	NULL,
+	NULL,
+	ht_bench_add,
+	ht_bench_remove,
+	ht_bench_contains,
+	ht_bench_size,
+	NULL,
+	NULL,
+	ht_options,
+	0,
+	NULL,
+	ht_memory,
+	NULL,
+	0,
+	NULL,
+	NULL,
+	NULL
+};
+
+int main(int argc, char **argv)
+{
+	return bench_main(argc, argv, &ht_ops);
+}
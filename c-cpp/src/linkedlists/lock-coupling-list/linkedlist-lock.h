@@ -34,6 +34,8 @@
 
 #include <atomic_ops.h>
 
+#include "bench.h"
+
 #define DEFAULT_DURATION                10000
 #define DEFAULT_INITIAL                 256
 #define DEFAULT_NB_THREADS              1
@@ -63,13 +65,13 @@ typedef intptr_t val_t;
 typedef pthread_mutex_t ptlock_t;
 #  define INIT_LOCK(lock)				pthread_mutex_init((pthread_mutex_t *) lock, NULL);
 #  define DESTROY_LOCK(lock)			pthread_mutex_destroy((pthread_mutex_t *) lock)
-#  define LOCK(lock)					pthread_mutex_lock((pthread_mutex_t *) lock)
+#  define LOCK(lock)					bench_locked(pthread_mutex_lock((pthread_mutex_t *) lock))
 #  define UNLOCK(lock)					pthread_mutex_unlock((pthread_mutex_t *) lock)
 #else
 typedef pthread_spinlock_t ptlock_t;
 #  define INIT_LOCK(lock)				pthread_spin_init((pthread_spinlock_t *) lock, PTHREAD_PROCESS_PRIVATE);
 #  define DESTROY_LOCK(lock)			pthread_spin_destroy((pthread_spinlock_t *) lock)
-#  define LOCK(lock)					pthread_spin_lock((pthread_spinlock_t *) lock)
+#  define LOCK(lock)					bench_locked(pthread_spin_lock((pthread_spinlock_t *) lock))
 #  define UNLOCK(lock)					pthread_spin_unlock((pthread_spinlock_t *) lock)
 #endif
 
@@ -1,6 +1,8 @@
 #ifndef __SET_H__
 #define __SET_H__
 
+#include <stddef.h>
+
 
 typedef unsigned long setkey_t;
 typedef void         *setval_t;
@@ -68,6 +70,13 @@ do {                                                            \
 
 typedef void set_t; /* opaque */
 
+/*
+ * Map mode: store a value of @size bytes in every node. To be called
+ * before _init_set_subsystem(), values are then handled with set_put(),
+ * set_get() and set_overwrite() rather than set_update() and set_lookup().
+ */
+void set_init_values(size_t size);
+
 void _init_set_subsystem(void);
 
 /*
@@ -96,8 +105,45 @@ set_t *set_alloc(void);
  */
 /*setval_t*/ int set_lookup(set_t *s, setkey_t k);
 
+/*
+ * Map mode: add a mapping from key @k to a copy of @val into set @s, if
+ * @k is not already mapped. Return 1 if the mapping was added.
+ */
+int set_put(set_t *s, setkey_t k, const void *val);
+
+/*
+ * Map mode: copy the value of key @k in set @s into @val. Return 1 if
+ * there was a mapping for @k, 0 leaving @val untouched otherwise.
+ */
+int set_get(set_t *s, setkey_t k, void *val);
+
+/*
+ * Map mode: replace the value of key @k in set @s with a copy of @val,
+ * in place. Return 1 if there was a mapping for @k.
+ */
+int set_overwrite(set_t *s, setkey_t k, const void *val);
+
+/*
+ * Fill empty set @s with the @n keys of @k, in increasing order, each
+ * mapped to itself. Not safe against concurrent accesses.
+ */
+void set_bulk_build(set_t *s, const setkey_t *k, long n);
+
+/*
+ * Store the keys of set @s in [@lo, @hi] into @keys, in increasing order,
+ * or only count them if @keys is NULL. Return how many there are. Weakly
+ * consistent: not atomic with respect to concurrent updates.
+ */
+long set_range(set_t *s, setkey_t lo, setkey_t hi, setkey_t *keys);
+
 void set_print(set_t *set);
 unsigned long set_count(set_t *set);
+
+/*
+ * Count the nodes and bytes set @s holds into @m, with no thread running.
+ */
+struct bench_mem;
+void set_memory(set_t *s, struct bench_mem *m);
 void set_print_nodenums(set_t *set);
 
 #endif /* __SET_IMPLEMENTATION__ */
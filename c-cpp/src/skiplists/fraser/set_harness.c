@@ -56,16 +56,12 @@
 #include "set.h"
 #include "ptst.h"
 
-/* This produces an operation log for the 'replay' checker. */
-/*#define DO_WRITE_LOG*/
-
-#ifdef DO_WRITE_LOG
-#define MAX_ITERATIONS 100000
-#define MAX_WALL_TIME 50 /* seconds */
-#else
+/*
+ * Operations are not logged here: the benchmark driver records them into
+ * a trace with -W and checks a run is linearizable with -C.
+ */
 #define MAX_ITERATIONS 100000000
 #define MAX_WALL_TIME 10 /* seconds */
-#endif
 
 /*
  * ***************** LOGGING
@@ -158,17 +154,6 @@ static void dump_log (void) {
 
 #define TVAL(x) ((x.tv_sec * 1000000) + x.tv_usec)
 
-/* Log tables. Written out at end-of-day. */
-typedef struct log_st
-{
-    interval_t    start, end;
-    unsigned int  key;
-    void         *val, *old_val; /* @old_val used by update() and remove() */
-} log_t;
-#define SIZEOF_GLOBAL_LOG (num_threads*MAX_ITERATIONS*sizeof(log_t))
-static log_t *global_log;
-static interval_t interval = 0;
-
 static bool_t go = FALSE;
 static int threads_initialised1 = 0, max_key, log_max_key;
 static int threads_initialised2 = 0;
@@ -210,10 +195,6 @@ static void *thread_start(void *arg)
     int i;
     void *ov, *v;
     int id = (int)arg;
-#ifdef DO_WRITE_LOG
-    log_t *log = global_log + id*MAX_ITERATIONS;
-    interval_t my_int;
-#endif
     unsigned long r = ((unsigned long)arg)+3; /*RDTICK();*/
     unsigned int prop = proportion;
     unsigned int _max_key = max_key;
@@ -243,7 +224,6 @@ static void *thread_start(void *arg)
     }
     while ( threads_initialised1 != num_threads ) MB();
 
-#ifndef DO_WRITE_LOG
     /* Start search structure off with a well-distributed set of inital keys */
     for ( i = (_max_key / num_threads); i != 0; i >>= 1 )
     {
@@ -254,7 +234,6 @@ static void *thread_start(void *arg)
                        (void *)0xdeadbee0, 1);
         }
     }
-#endif
 
     {
         int n_id, id = threads_initialised2;
@@ -278,17 +257,11 @@ static void *thread_start(void *arg)
         while ( !go ) MB();
     }
 
-#ifdef DO_WRITE_LOG
-    get_interval(my_int);
-#endif
     for ( i = 0; (i < MAX_ITERATIONS) && !shared.alarm_time; i++ )
     {
         /* O-3: ignore ; 4-11: proportion ; 12: ins/del */
         k = (nrand(r) >> 4) & (_max_key - 1);
         nrand(r);
-#ifdef DO_WRITE_LOG
-        log->start = my_int;
-#endif
         if ( ((r>>4)&255) < prop )
         {
             ov = v = set_lookup(shared.set, k);
@@ -303,15 +276,6 @@ static void *thread_start(void *arg)
             v = NULL;
             ov = set_remove(shared.set, k);
         }
-
-#ifdef DO_WRITE_LOG
-        get_interval(my_int);
-        log->key = k;
-        log->val = v;
-        log->old_val = ov;
-        log->end = my_int;
-        log++;
-#endif
     }
 
     /* BARRIER FOR ALL THREADS */
@@ -456,24 +420,12 @@ static void tstp_handler(int sig, siginfo_t *info, ucontext_t *uc)
 
 int main (int argc, char **argv)
 {
-#ifdef DO_WRITE_LOG
-    int fd;
-    unsigned long log_header[] = { 0, MAX_ITERATIONS, 0 };
-
-    if ( argc != 5 )
-    {
-        printf("%s <num_threads> <read_proportion> <key power> <log name>\n"
-               "(0 <= read_proportion <= 256)\n", argv[0]);
-        exit(1);
-    }
-#else
     if ( argc != 4 )
     {
         printf("%s <num_threads> <read_proportion> <key power>\n"
                "(0 <= read_proportion <= 256)\n", argv[0]);
         exit(1);
     }
-#endif
 
     memset(&shared, 0, sizeof(shared));
 
@@ -528,12 +480,6 @@ int main (int argc, char **argv)
     }
 #endif
 
-#ifdef DO_WRITE_LOG
-    log_header[0] = num_threads;
-    log_header[2] = max_key;
-    global_log = malloc(SIZEOF_GLOBAL_LOG);
-#endif
-
 #if defined(INTEL)
     {
         struct sigaction act;
@@ -550,26 +496,5 @@ int main (int argc, char **argv)
 
     dump_log ();
 
-#ifdef DO_WRITE_LOG
-    printf("Writing log...\n");
-    /* Write logs to data file */
-    fd = open(argv[4], O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if ( fd == -1 )
-    {
-        fprintf(stderr, "Error writing log!\n");
-        exit(-1);
-    }
-
-    if ( (write(fd, log_header, sizeof(log_header)) != sizeof(log_header)) ||
-         (write(fd, global_log, SIZEOF_GLOBAL_LOG) != SIZEOF_GLOBAL_LOG) )
-    {
-        fprintf(stderr, "Log write truncated or erroneous\n");
-        close(fd);
-        exit(-1);
-    }
-
-    close(fd);
-#endif
-
     exit(0);
 }
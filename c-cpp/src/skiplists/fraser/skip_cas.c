@@ -42,6 +42,7 @@
 #include "portable_defns.h"
 #include "ptst.h"
 #include "set.h"
+#include "bench.h"
 
 
 /*
@@ -69,6 +70,24 @@ struct set_st
 
 static int gc_id[NUM_LEVELS];
 
+/*
+ * Map mode: the value of a node is stored right after its forward
+ * pointers and the node's value field points to it. Writers copy it in
+ * under a sequence number, odd while a copy is in progress, and readers
+ * retry until they copied it out with the number even and unchanged.
+ */
+typedef struct value_st value_t;
+
+struct value_st
+{
+    VOLATILE unsigned long seq;
+    unsigned long w[1];
+};
+
+static size_t value_size; /* bytes, 0 for a set */
+
+#define node_value(_n) ((value_t *)&(_n)->next[(_n)->level & LEVEL_MASK])
+
 /*
  * PRIVATE FUNCTIONS
  */
@@ -103,6 +122,17 @@ static node_t *alloc_node(ptst_t *ptst)
 }
 
 
+/* Copy @val in as the value of the new node @n, return the value field. */
+static setval_t init_value(sh_node_pt n, const void *val)
+{
+    value_t *x = node_value(n);
+
+    x->seq = 0;
+    memcpy(x->w, val, value_size);
+    return(x);
+}
+
+
 /* Free a node to the garbage collector. */
 static void free_node(ptst_t *ptst, sh_node_pt n)
 {
@@ -293,7 +323,41 @@ set_t *set_alloc(void)
 }
 
 
-int set_update(set_t *l, setkey_t k, setval_t v, int overwrite)
+/*
+ * Perfect skip list: the i-th node (from 1) rises to level 1 + ctz(i).
+ * Nodes are carved in key order from contiguous storage; once removed,
+ * the garbage collector recycles them like any node of their level.
+ */
+void set_bulk_build(set_t *l, const setkey_t *k, long n)
+{
+    sh_node_pt preds[NUM_LEVELS], tail = l->head.next[0];
+    node_t *x;
+    long i;
+    int j, level;
+
+    for ( j = 0; j < NUM_LEVELS; j++ ) preds[j] = &l->head;
+    for ( i = 1; i <= n; i++ )
+    {
+        level = 1 + __builtin_ctzl((unsigned long)i);
+        if ( level > NUM_LEVELS ) level = NUM_LEVELS;
+        x = bench_bulk_alloc(sizeof(node_t) + (level-1)*sizeof(node_t *));
+        x->level = level;
+        x->k = CALLER_TO_INTERNAL_KEY(k[i-1]);
+        x->v = (setval_t)k[i-1];
+        for ( j = 0; j < level; j++ )
+        {
+            preds[j]->next[j] = x;
+            preds[j] = x;
+        }
+    }
+    for ( j = 0; j < NUM_LEVELS; j++ ) preds[j]->next[j] = tail;
+    MB();
+}
+
+
+/* Map @k to @v, or to a copy of @val in map mode if @val is not NULL. */
+static int do_update(set_t *l, setkey_t k, setval_t v, const void *val,
+                     int overwrite)
 {
     setval_t  ov, new_ov;
     ptst_t    *ptst;
@@ -347,7 +411,7 @@ int set_update(set_t *l, setkey_t k, setval_t v, int overwrite)
     {
         new    = alloc_node(ptst);
         new->k = k;
-        new->v = v;
+        new->v = (val != NULL) ? init_value(new, val) : v;
     }
     level = new->level;
 
@@ -417,6 +481,18 @@ int set_update(set_t *l, setkey_t k, setval_t v, int overwrite)
 }
 
 
+int set_update(set_t *l, setkey_t k, setval_t v, int overwrite)
+{
+    return(do_update(l, k, v, NULL, overwrite));
+}
+
+
+int set_put(set_t *l, setkey_t k, const void *val)
+{
+    return(do_update(l, k, NULL, val, 0));
+}
+
+
 int set_remove(set_t *l, setkey_t k)
 {
     setval_t  v = NULL, new_v;
@@ -497,6 +573,108 @@ int set_lookup(set_t *l, setkey_t k)
     return(result);
 }
 
+int set_get(set_t *l, setkey_t k, void *val)
+{
+    value_t   *x = NULL;
+    unsigned long seq;
+    ptst_t    *ptst;
+    sh_node_pt n;
+
+    k = CALLER_TO_INTERNAL_KEY(k);
+
+    ptst = critical_enter();
+
+    n = weak_search_predecessors(l, k, NULL, NULL);
+    if ( n->k == k ) READ_FIELD(x, n->v);
+    if ( x != NULL )
+    {
+        do {
+            while ( ((seq = x->seq) & 1) ) ;
+            RMB();
+            memcpy(val, x->w, value_size);
+            RMB();
+        }
+        while ( x->seq != seq );
+    }
+
+    critical_exit(ptst);
+
+    return(x != NULL);
+}
+
+
+/*
+ * A removal may happen during the copy. As the value stays in place until
+ * the node is reclaimed, the overwrite then takes effect just before it.
+ */
+int set_overwrite(set_t *l, setkey_t k, const void *val)
+{
+    value_t   *x = NULL;
+    unsigned long seq;
+    ptst_t    *ptst;
+    sh_node_pt n;
+
+    k = CALLER_TO_INTERNAL_KEY(k);
+
+    ptst = critical_enter();
+
+    n = weak_search_predecessors(l, k, NULL, NULL);
+    if ( n->k == k ) READ_FIELD(x, n->v);
+    if ( x != NULL )
+    {
+        do {
+            while ( ((seq = x->seq) & 1) ) ;
+        }
+        while ( CASIO(&x->seq, seq, seq + 1) != seq );
+        memcpy(x->w, val, value_size);
+        WMB();
+        x->seq = seq + 2;
+    }
+
+    critical_exit(ptst);
+
+    return(x != NULL);
+}
+
+
+/*
+ * Walks the bottom level from the first node with a key >= @lo, marked
+ * nodes included: each key is read at some point of the scan, but nodes
+ * inserted or deleted behind it are missed or reported.
+ */
+long set_range(set_t *l, setkey_t lo, setkey_t hi, setkey_t *keys)
+{
+    setval_t  v;
+    setkey_t  k;
+    ptst_t    *ptst;
+    sh_node_pt x;
+    long n = 0;
+
+    lo = CALLER_TO_INTERNAL_KEY(lo);
+    hi = CALLER_TO_INTERNAL_KEY(hi);
+
+    ptst = critical_enter();
+
+    x = weak_search_predecessors(l, lo, NULL, NULL);
+    for ( ; ; )
+    {
+        READ_FIELD(k, x->k);
+        if ( k > hi ) break;
+        READ_FIELD(v, x->v);
+        if ( v != NULL )
+        {
+            if ( keys ) keys[n] = k - 2;
+            n++;
+        }
+        READ_FIELD(x, x->next[0]);
+        x = get_unmarked_ref(x);
+    }
+
+    critical_exit(ptst);
+
+    return(n);
+}
+
 void set_print(set_t *set)
 {
 	node_t *curr;
@@ -535,6 +713,37 @@ unsigned long set_count(set_t *set)
         return i;
 }
 
+/*
+ * Nodes of a level come from the collector's pool of that level, with room
+ * for a value in map mode. Deleted nodes still linked count as retired,
+ * unlinked ones waiting for their epoch to end are not counted.
+ */
+void set_memory(set_t *set, bench_mem_t *m)
+{
+    node_t *curr;
+    long extra = (value_size > 0) ? sizeof(unsigned long) + value_size : 0;
+
+    m->index_nodes = 2;
+    m->bytes = sizeof(*set) + sizeof(node_t) + 2*(NUM_LEVELS-1)*sizeof(node_t *);
+    curr = get_unmarked_ref(set->head.next[0]);
+    while ( SENTINEL_KEYMAX != curr->k )
+    {
+        if ( curr->v != NULL && curr->v != curr )
+        {
+            m->nodes++;
+            m->bytes += sizeof(node_t) +
+                ((curr->level & LEVEL_MASK)-1)*sizeof(node_t *) + extra;
+        }
+        else
+        {
+            m->retired++;
+            m->retired_bytes += sizeof(node_t) +
+                ((curr->level & LEVEL_MASK)-1)*sizeof(node_t *) + extra;
+        }
+        curr = get_unmarked_ref(curr->next[0]);
+    }
+}
+
 void set_print_nodenums(set_t *set)
 {
         node_t *curr;
@@ -553,13 +762,21 @@ void set_print_nodenums(set_t *set)
         }
 }
 
+void set_init_values(size_t size)
+{
+    value_size = size;
+}
+
+
 void _init_set_subsystem(void)
 {
-    int i;
+    int i, extra = 0;
 
+    if ( value_size > 0 ) extra = sizeof(unsigned long) + value_size;
     for ( i = 0; i < NUM_LEVELS; i++ )
     {
-        gc_id[i] = gc_add_allocator(sizeof(node_t) + i*sizeof(node_t *));
+        gc_id[i] = gc_add_allocator(sizeof(node_t) + i*sizeof(node_t *) +
+                                    extra);
     }
 
     printf("_init_set_subsystem() done\n");
@@ -66,6 +66,7 @@ reads from memory to occur.
 #include "garbagecoll.h"
 #include "ptst.h"
 #include "common.h"
+#include "bench.h"
 
 /* - Private variables - */
 
@@ -122,6 +123,8 @@ static void* bg_loop(void *args)
 
         assert(NULL != set);
 
+        bench_pin_background();
+
         while (1) {
                 if (bg_finished)
                         break;
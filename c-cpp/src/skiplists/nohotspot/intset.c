@@ -41,3 +41,8 @@ int sl_remove_old(set_t *set, unsigned int key, int transactional)
 {
 	return sl_delete(set, (sl_key_t) key);
 }
+
+long sl_range_old(set_t *set, sl_key_t lo, sl_key_t hi, sl_key_t *keys)
+{
+        return sl_range(set, lo, hi, keys);
+}
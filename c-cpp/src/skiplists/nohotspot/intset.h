@@ -29,5 +29,6 @@
 int sl_contains_old(set_t *set, unsigned int key, int transactional);
 int sl_add_old(set_t *set, unsigned int key, int transactional);
 int sl_remove_old(set_t *set, unsigned int key, int transactional);
+long sl_range_old(set_t *set, sl_key_t lo, sl_key_t hi, sl_key_t *keys);
 
 #endif /* INTSET_H_ */
@@ -262,3 +262,62 @@ int sl_do_operation(set_t *set, sl_optype_t optype, sl_key_t key, val_t val)
 
         return result;
 }
+
+/**
+ * sl_range - collect the keys of the set in [lo, hi]
+ * @set: the set
+ * @lo: the lowest key
+ * @hi: the highest key
+ * @keys: where to store the keys, in increasing order, or NULL to only
+ *        count them
+ *
+ * Returns the number of keys found. The scan is weakly consistent: it
+ * follows the node level without helping removals, and sees each node
+ * at some point during the scan, not all of them at once.
+ */
+long sl_range(set_t *set, sl_key_t lo, sl_key_t hi, sl_key_t *keys)
+{
+        inode_t *item = NULL, *next_item = NULL;
+        node_t *node = NULL;
+        val_t node_val = NULL;
+        long n = 0;
+        ptst_t *ptst;
+
+        assert(NULL != set);
+
+#ifdef USE_GC
+        ptst = ptst_critical_enter();
+#endif
+
+        /* find an entry-point to the node-level */
+        item = set->top;
+        while (1) {
+                next_item = item->right;
+                if (NULL == next_item || next_item->node->key >= lo) {
+                        next_item = item->down;
+                        if (NULL == next_item) {
+                                node = item->node;
+                                break;
+                        }
+                }
+                item = next_item;
+        }
+        while (node == node->val)
+                node = node->prev;
+        /* walk the node level up to hi */
+        for (; NULL != node && node->key <= hi; node = node->next) {
+                node_val = node->val;
+                if (node->key < lo || NULL == node_val ||
+                    node == node_val || node->marker)
+                        continue;
+                if (NULL != keys)
+                        keys[n] = node->key;
+                n++;
+        }
+
+#ifdef USE_GC
+        ptst_critical_exit(ptst);
+#endif
+
+        return n;
+}
@@ -18,6 +18,7 @@ enum sl_optype {
 };
 
 int sl_do_operation(set_t *set, sl_optype_t optype, sl_key_t key, val_t val);
+long sl_range(set_t *set, sl_key_t lo, sl_key_t hi, sl_key_t *keys);
 
 /* these are macros instead of functions to improve performance */
 #define sl_contains(a, b) sl_do_operation((a), CONTAINS, (b), NULL);
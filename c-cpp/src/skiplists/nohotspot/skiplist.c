@@ -38,6 +38,7 @@ to implement this way.
 #include "background.h"
 #include "garbagecoll.h"
 #include "ptst.h"
+#include "bench.h"
 
 static int gc_id[NUM_LEVELS];
 
@@ -152,6 +153,66 @@ set_t* set_new(int start)
         return set;
 }
 
+/**
+ * set_bulk_build - fill an empty set from sorted keys
+ * @set: the set to fill, with its background thread stopped
+ * @keys: the keys, distinct and in increasing order
+ * @n: the number of keys
+ *
+ * Note: the index is perfectly balanced, the i-th node (from 1) being
+ * raised to ctz(i) index levels, which is the shape the background
+ * thread converges to. Each node is followed in memory by its index
+ * nodes, all in key order; once removed, the garbage collector recycles
+ * them like any other.
+ */
+void set_bulk_build(set_t *set, const sl_key_t *keys, long n)
+{
+        inode_t *ilast[MAX_LEVELS], *inode, *below;
+        node_t  *prev, *node;
+        long i;
+        int levels, l, h;
+
+        for (levels = 1; levels < MAX_LEVELS - 1 && (2L << levels) <= n; levels++)
+                ;
+        /* the head's column of index nodes, from the bottom */
+        inode = set->top;
+        while (set->head->level < levels) {
+                inode = bench_bulk_alloc(sizeof(inode_t));
+                inode->right = NULL;
+                inode->down  = set->top;
+                inode->node  = set->head;
+                set->top = inode;
+                ++set->head->level;
+        }
+        for (l = levels - 1, inode = set->top; l >= 0; l--, inode = inode->down)
+                ilast[l] = inode;
+
+        prev = set->head;
+        for (i = 1; i <= n; i++) {
+                h = __builtin_ctzl((unsigned long)i);
+                if (h > levels)
+                        h = levels;
+                node = bench_bulk_alloc(sizeof(node_t));
+                node->key    = keys[i - 1];
+                node->val    = (val_t)keys[i - 1];
+                node->prev   = prev;
+                node->next   = NULL;
+                node->level  = h;
+                node->marker = 0;
+                prev->next = node;
+                prev = node;
+                for (l = 0, below = NULL; l < h; l++, below = inode) {
+                        inode = bench_bulk_alloc(sizeof(inode_t));
+                        inode->right = NULL;
+                        inode->down  = below;
+                        inode->node  = node;
+                        ilast[l]->right = inode;
+                        ilast[l] = inode;
+                }
+        }
+        AO_nop_full();
+}
+
 /**
  * set_delete - delete the set
  * @set: the set to delete
@@ -226,6 +287,40 @@ int set_size(set_t *set, int flag)
         return size;
 }
 
+/**
+ * set_memory - count the memory held by the set
+ * @set: the set, with no thread running on it
+ * @m: the counts to fill in
+ *
+ * Note: only nodes still linked are counted, deleted ones as retired.
+ * The garbage collector is minimal and never reclaims, unlinked nodes
+ * are lost to it.
+ */
+void set_memory(set_t *set, bench_mem_t *m)
+{
+        node_t  *node;
+        inode_t *ihead, *itemp;
+        long inodes = 0;
+
+        for (ihead = set->top; NULL != ihead; ihead = ihead->down)
+                for (itemp = ihead; NULL != itemp; itemp = itemp->right)
+                        ++inodes;
+
+        m->index_nodes = 1 + inodes;
+        for (node = set->head->next; NULL != node; node = node->next) {
+                if (node->marker)
+                        ++m->index_nodes;
+                else if (NULL != node->val && node != node->val)
+                        ++m->nodes;
+                else
+                        ++m->retired;
+        }
+
+        m->bytes = sizeof(set_t) + (m->index_nodes - inodes + m->nodes) * sizeof(node_t)
+                + inodes * sizeof(inode_t);
+        m->retired_bytes = m->retired * sizeof(node_t);
+}
+
 /**
  * set_subsystem_init - initialise the set subsystem
  */
@@ -41,6 +41,8 @@ struct sl_inode {
         struct sl_node  *node;
 };
 
+struct bench_mem;
+
 /* the skip list set */
 typedef VOLATILE struct sl_set set_t;
 struct sl_set {
@@ -58,9 +60,11 @@ void node_delete(node_t *node, ptst_t *ptst);
 void inode_delete(inode_t *inode, ptst_t *ptst);
 
 set_t* set_new(int bg_start);
+void set_bulk_build(set_t *set, const sl_key_t *keys, long n);
 void set_delete(set_t *set);
 void set_print(set_t *set, int flag);
 int set_size(set_t *set, int flag);
+void set_memory(set_t *set, struct bench_mem *m);
 
 void set_subsystem_init(void);
 
@@ -54,6 +54,7 @@ common with other multi-threaded skip list implementations.
 #include "skiplist.h"
 #include "garbagecoll.h"
 #include "ptst.h"
+#include "bench.h"
 
 static set_t *set;      /* the set to maintain */
 
@@ -116,6 +117,7 @@ static void* bg_loop(void *args)
         unsigned long zero;
 
         assert(NULL != set);
+        bench_pin_background();
         bg_counter = 0;
         bg_go = 0;
         bg_should_delete = 1;
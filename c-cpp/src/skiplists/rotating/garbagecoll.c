@@ -442,6 +442,34 @@ void gc_free(ptst_t *ptst, void *p, int alloc_id)
 #endif
 }
 
+/**
+ * gc_garbage_count - count the blocks waiting for reclamation
+ * @alloc_id: the allocator of the blocks
+ *
+ * Note: not thread-safe, no thread may free blocks meanwhile.
+ */
+unsigned long gc_garbage_count(int alloc_id)
+{
+        unsigned long count = 0;
+        ptst_t *ptst;
+        gc_chunk *ch, *t;
+        int e;
+
+        for (ptst = ptst_first(); NULL != ptst; ptst = ptst_next(ptst)) {
+                for (e = 0; e < NUM_EPOCHS; e++) {
+                        ch = ptst->gc->garbage[e][alloc_id];
+                        if (NULL == ch)
+                                continue;
+                        t = ch;
+                        do {
+                                count += t->i;
+                        } while ((t = t->next) != ch);
+                }
+        }
+
+        return count;
+}
+
 /**
  * gc_add_ptr_to_hook_list - ...
  * @ptst: per-thread state
@@ -27,6 +27,7 @@ void gc_remove_allocator(int alloc_id);
 void* gc_alloc(ptst_t *ptst, int alloc_id);
 void gc_free(ptst_t *ptst, void *p, int alloc_id);
 void gc_free_unsafe(ptst_t *ptst, void *p, int alloc_id);
+unsigned long gc_garbage_count(int alloc_id);
 
 /* Hook registry - allows users to hook in their own epoch-delay lists */
 typedef void (*gc_hookfn)(ptst_t*, void*);
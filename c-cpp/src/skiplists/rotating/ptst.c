@@ -22,7 +22,7 @@ Detailed description goes here.
 /* - Globals - */
 pthread_key_t  ptst_key;
 ptst_t *ptst_list;
-static unsigned int next_id;
+static AO_t next_id; /* CAS() operates on whole words */
 
 /* - Private function declarations - */
 static void ptst_destructor(ptst_t *ptst);
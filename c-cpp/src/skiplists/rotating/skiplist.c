@@ -38,6 +38,9 @@ to implement this way.
 #include "background.h"
 #include "garbagecoll.h"
 #include "ptst.h"
+#include "bench.h"
+
+unsigned long sl_zero;
 
 static int gc_id[NUM_SIZES];
 static int curr_id;
@@ -160,6 +163,57 @@ set_t* set_new(int start)
         return set;
 }
 
+/**
+ * set_bulk_build - fill an empty set from sorted keys
+ * @set: the set to fill, with its background thread stopped
+ * @keys: the keys, distinct and in increasing order
+ * @n: the number of keys
+ *
+ * Note: the index is perfectly balanced, the i-th node (from 1) being
+ * raised to ctz(i) index levels. Nodes are laid out in key order; once
+ * removed, the garbage collector recycles them like any other.
+ */
+void set_bulk_build(set_t *set, const unsigned long *keys, long n)
+{
+        node_t *ilast[MAX_LEVELS], *prev, *node;
+        unsigned long zero = sl_zero;
+        unsigned long levels, h, l;
+        long i;
+
+        for (levels = 1; levels < MAX_LEVELS - 1 && (2L << levels) <= n; levels++)
+                ;
+        for (l = set->head->level; l < levels; l++)
+                set->head->succs[IDX(l, zero)] = NULL;
+        if (set->head->level < levels)
+                set->head->level = levels;
+        for (l = 0; l < levels; l++)
+                ilast[l] = set->head;
+
+        prev = set->head;
+        for (i = 1; i <= n; i++) {
+                h = __builtin_ctzl((unsigned long)i);
+                if (h > levels)
+                        h = levels;
+                node = bench_bulk_alloc(sizeof(node_t));
+                node->key       = keys[i - 1];
+                node->val       = (void*)keys[i - 1];
+                node->prev      = prev;
+                node->next      = NULL;
+                node->level     = h;
+                node->marker    = 0;
+                node->raise_or_remove = (h > 0);
+                for (l = 0; l < MAX_LEVELS; l++)
+                        node->succs[l] = NULL;
+                prev->next = node;
+                prev = node;
+                for (l = 0; l < h; l++) {
+                        ilast[l]->succs[IDX(l, zero)] = node;
+                        ilast[l] = node;
+                }
+        }
+        AO_nop_full();
+}
+
 /**
  * set_delete - delete the set
  * @set: the set to delete
@@ -232,6 +286,34 @@ int set_size(set_t *set, int flag)
         return size;
 }
 
+/**
+ * set_memory - count the memory held by the set
+ * @set: the set, with no thread running on it
+ * @m: the counts to fill in
+ *
+ * Note: index levels live in the succs of the bottom-level nodes, only
+ * the head and the markers are counted as index nodes. Deleted nodes
+ * still linked and nodes on the garbage lists are retired.
+ */
+void set_memory(set_t *set, bench_mem_t *m)
+{
+        node_t *node;
+
+        m->index_nodes = 1;
+        for (node = set->head->next; NULL != node; node = node->next) {
+                if (node->marker)
+                        ++m->index_nodes;
+                else if (node != node->val && NULL != node->val)
+                        ++m->nodes;
+                else
+                        ++m->retired;
+        }
+        m->retired += gc_garbage_count(gc_id[curr_id]);
+
+        m->bytes = sizeof(set_t) + (m->nodes + m->index_nodes) * sizeof(node_t);
+        m->retired_bytes = m->retired * sizeof(node_t);
+}
+
 /**
  * set_subsystem_init - ...
  */
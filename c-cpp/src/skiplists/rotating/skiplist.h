@@ -19,7 +19,7 @@
 #define NODE_SIZE 0
 
 #define IDX(_i, _z) ((_z) + (_i)) % MAX_LEVELS
-unsigned long sl_zero;
+extern unsigned long sl_zero;
 
 /* bottom-level nodes */
 typedef VOLATILE struct sl_node node_t;
@@ -34,6 +34,8 @@ struct sl_node {
         unsigned long   raise_or_remove;
 };
 
+struct bench_mem;
+
 /* the skip list set */
 typedef struct sl_set set_t;
 struct sl_set {
@@ -49,9 +51,11 @@ void node_delete(node_t *node, ptst_t *ptst);
 void marker_delete(node_t *node, ptst_t *ptst);
 
 set_t* set_new(int start);
+void set_bulk_build(set_t *set, const unsigned long *keys, long n);
 void set_delete(set_t *set);
 void set_print(set_t *set, int flag);
 int set_size(set_t *set, int flag);
+void set_memory(set_t *set, struct bench_mem *m);
 
 void set_subsystem_init(void);
 void set_print_nodenums(set_t *set, int flag);
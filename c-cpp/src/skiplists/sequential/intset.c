@@ -21,7 +21,10 @@
  * GNU General Public License for more details.
  */
 
+#include <string.h>
+
 #include "intset.h"
+#include "bench.h"
 
 #define MAXLEVEL    32
 
@@ -88,7 +91,65 @@ int sl_contains(sl_intset_t *set, val_t val, int transactional)
 	return result;
 }
 
-inline int sl_seq_add(sl_intset_t *set, val_t val) {
+/*
+ * Stores the keys in [lo, hi] into keys, or only counts them if keys is
+ * NULL. Under STM the scan is a single normal transaction, so it is
+ * atomic whatever the elasticity.
+ */
+long sl_range(sl_intset_t *set, val_t lo, val_t hi, val_t *keys)
+{
+	long n = 0;
+	
+#ifdef SEQUENTIAL /* Unprotected */
+	
+	int i;
+	sl_node_t *node, *next;
+	
+	node = set->head;
+	for (i = node->toplevel-1; i >= 0; i--) {
+		next = node->next[i];
+		while (next->val < lo) {
+			node = next;
+			next = node->next[i];
+		}
+	}
+	for (node = node->next[0]; node->val <= hi; node = node->next[0]) {
+		if (keys != NULL)
+			keys[n] = node->val;
+		n++;
+	}
+		
+#elif defined STM
+	
+	int i;
+	sl_node_t *node, *next;
+	val_t v;
+
+	TX_START(NL);
+	n = 0;
+	node = set->head;
+	for (i = node->toplevel-1; i >= 0; i--) {
+	  next = (sl_node_t *)TX_LOAD(&node->next[i]);
+	  while (TX_LOAD(&next->val) < lo) {
+	    node = next;
+	    next = (sl_node_t *)TX_LOAD(&node->next[i]);
+	  }
+	}
+	node = (sl_node_t *)TX_LOAD(&node->next[0]);
+	while ((v = TX_LOAD(&node->val)) <= hi) {
+	  if (keys != NULL)
+	    keys[n] = v;
+	  n++;
+	  node = (sl_node_t *)TX_LOAD(&node->next[0]);
+	}
+	TX_END;
+	
+#endif
+	
+	return n;
+}
+
+inline int sl_seq_add(sl_intset_t *set, val_t val, const val_t *value) {
 	int i, l, result;
 	sl_node_t *node, *next;
 	sl_node_t *preds[MAXLEVEL], *succs[MAXLEVEL];
@@ -107,6 +168,8 @@ inline int sl_seq_add(sl_intset_t *set, val_t val) {
 	if ((result = (node->val != val)) == 1) {
 		l = get_rand_level();
 		node = sl_new_simple_node(val, l, 0);
+		if (value != NULL)
+			memcpy(sl_node_value(node), value, value_size);
 		for (i = 0; i < l; i++) {
 			node->next[i] = succs[i];
 			preds[i]->next[i] = node;
@@ -115,19 +178,24 @@ inline int sl_seq_add(sl_intset_t *set, val_t val) {
 	return result;
 }
 
-int sl_add(sl_intset_t *set, val_t val, int transactional)
+/*
+ * Inserts val with a copy of the value_size bytes at value, or without
+ * value if value is NULL. The new node is private until it is linked so
+ * its value is copied without transactional accesses.
+ */
+int sl_put(sl_intset_t *set, val_t val, const val_t *value, int transactional)
 {
   int result = 0;
 	
   if (!transactional) {
 		
-    result = sl_seq_add(set, val);
+    result = sl_seq_add(set, val, value);
 	
   } else {
 
 #ifdef SEQUENTIAL
 		
-	result = sl_seq_add(set, val);
+	result = sl_seq_add(set, val, value);
 		
 #elif defined STM
 	
@@ -152,6 +220,8 @@ int sl_add(sl_intset_t *set, val_t val, int transactional)
 	  if ((result = (v != val)) == 1) {
 	    l = get_rand_level();
 	    node = sl_new_simple_node(val, l, transactional);
+	    if (value != NULL)
+	      memcpy(sl_node_value(node), value, value_size);
 	    for (i = 0; i < l; i++) {
 	      node->next[i] = (sl_node_t *)TX_LOAD(&preds[i]->next[i]);	
 	      TX_STORE(&preds[i]->next[i], node);
@@ -175,6 +245,8 @@ int sl_add(sl_intset_t *set, val_t val, int transactional)
 	  if ((result = (v != val)) == 1) {
 	    l = get_rand_level();
 	    node = sl_new_simple_node(val, l, transactional);
+	    if (value != NULL)
+	      memcpy(sl_node_value(node), value, value_size);
 	    for (i = 0; i < l; i++) {
 	      node->next[i] = (sl_node_t *)TX_LOAD(&preds[i]->next[i]);	
 	      TX_STORE(&preds[i]->next[i], node);
@@ -191,6 +263,118 @@ int sl_add(sl_intset_t *set, val_t val, int transactional)
   return result;
 }
 
+int sl_add(sl_intset_t *set, val_t val, int transactional)
+{
+  return sl_put(set, val, NULL, transactional);
+}
+
+/*
+ * Copies the value of val into value if val is present. Unlike contains,
+ * the transaction is never elastic: the copy needs a consistent view of
+ * all the words of the value.
+ */
+int sl_get(sl_intset_t *set, val_t val, val_t *value, int transactional)
+{
+	int result = 0;
+	
+#ifdef SEQUENTIAL
+	
+	int i;
+	sl_node_t *node, *next;
+	
+	node = set->head;
+	for (i = node->toplevel-1; i >= 0; i--) {
+		next = node->next[i];
+		while (next->val < val) {
+			node = next;
+			next = node->next[i];
+		}
+	}
+	node = node->next[0];
+	if ((result = (node->val == val)) == 1)
+		memcpy(value, sl_node_value(node), value_size);
+		
+#elif defined STM
+	
+	int i;
+	sl_node_t *node, *next;
+	val_t v = VAL_MIN, *w;
+
+	TX_START(NL);
+	node = set->head;
+	for (i = node->toplevel-1; i >= 0; i--) {
+	  next = (sl_node_t *)TX_LOAD(&node->next[i]);
+	  while ((v = TX_LOAD(&next->val)) < val) {
+	    node = next;
+	    next = (sl_node_t *)TX_LOAD(&node->next[i]);
+	  }
+	}
+	node = (sl_node_t *)TX_LOAD(&node->next[0]);
+	if ((result = (v == val)) == 1) {
+	  w = sl_node_value(node);
+	  for (i = 0; i < value_size / sizeof(val_t); i++)
+	    value[i] = TX_LOAD(&w[i]);
+	}
+	TX_END;
+	
+#endif
+	
+	return result;
+}
+
+/*
+ * Replaces the value of val, in place, with the value_size bytes at
+ * value if val is present.
+ */
+int sl_overwrite(sl_intset_t *set, val_t val, const val_t *value, int transactional)
+{
+	int result = 0;
+	
+#ifdef SEQUENTIAL
+	
+	int i;
+	sl_node_t *node, *next;
+	
+	node = set->head;
+	for (i = node->toplevel-1; i >= 0; i--) {
+		next = node->next[i];
+		while (next->val < val) {
+			node = next;
+			next = node->next[i];
+		}
+	}
+	node = node->next[0];
+	if ((result = (node->val == val)) == 1)
+		memcpy(sl_node_value(node), value, value_size);
+		
+#elif defined STM
+	
+	int i;
+	sl_node_t *node, *next;
+	val_t v = VAL_MIN, *w;
+
+	TX_START(NL);
+	node = set->head;
+	for (i = node->toplevel-1; i >= 0; i--) {
+	  next = (sl_node_t *)TX_LOAD(&node->next[i]);
+	  while ((v = TX_LOAD(&next->val)) < val) {
+	    node = next;
+	    next = (sl_node_t *)TX_LOAD(&node->next[i]);
+	  }
+	}
+	node = (sl_node_t *)TX_LOAD(&node->next[0]);
+	if ((result = (v == val)) == 1) {
+	  w = sl_node_value(node);
+	  for (i = 0; i < value_size / sizeof(val_t); i++)
+	    TX_STORE(&w[i], value[i]);
+	}
+	TX_END;
+	
+#endif
+	
+	return result;
+}
+
 int sl_remove(sl_intset_t *set, val_t val, int transactional)
 {
 	int result = 0;
@@ -245,7 +429,8 @@ int sl_remove(sl_intset_t *set, val_t val, int transactional)
 		TX_STORE(&preds[i]->next[i], (sl_node_t *)TX_LOAD(&succs[i]->next[i])); 
 	      }
 	    }
-	    FREE(next, sizeof(sl_node_t) + next->toplevel * sizeof(sl_node_t *));
+	    if (!bench_bulk_owns(next))
+	      FREE(next, sizeof(sl_node_t) + next->toplevel * sizeof(sl_node_t *) + value_size);
 	  }
 	  TX_END;
 
@@ -269,7 +454,8 @@ int sl_remove(sl_intset_t *set, val_t val, int transactional)
 		TX_STORE(&preds[i]->next[i], (sl_node_t *)TX_LOAD(&succs[i]->next[i])); 
 	      }
 	    }
-	    FREE(next, sizeof(sl_node_t) + next->toplevel * sizeof(sl_node_t *));
+	    if (!bench_bulk_owns(next))
+	      FREE(next, sizeof(sl_node_t) + next->toplevel * sizeof(sl_node_t *) + value_size);
 	  }
 	  TX_END;
 
@@ -24,5 +24,9 @@
 #include "fraser.h"
 
 int sl_contains(sl_intset_t *set, val_t val, int transactional);
+long sl_range(sl_intset_t *set, val_t lo, val_t hi, val_t *keys);
 int sl_add(sl_intset_t *set, val_t val, int transactional);
+int sl_put(sl_intset_t *set, val_t val, const val_t *value, int transactional);
+int sl_get(sl_intset_t *set, val_t val, val_t *value, int transactional);
+int sl_overwrite(sl_intset_t *set, val_t val, const val_t *value, int transactional);
 int sl_remove(sl_intset_t *set, val_t val, int transactional);
@@ -22,8 +22,10 @@
  */
 
 #include "skiplist.h"	
+#include "bench.h"
 
 unsigned int levelmax;
+unsigned int value_size;
 
 /*
  * Returns a random level for inserting a new node, results are hardwired to p=0.5, min=1, max=32.
@@ -69,9 +71,9 @@ sl_node_t *sl_new_simple_node(val_t val, int toplevel, int transactional)
   sl_node_t *node;
 
   if (transactional)
-    node = (sl_node_t *)MALLOC(sizeof(sl_node_t) + toplevel * sizeof(sl_node_t *));
+    node = (sl_node_t *)MALLOC(sizeof(sl_node_t) + toplevel * sizeof(sl_node_t *) + value_size);
   else 
-    node = (sl_node_t *)malloc(sizeof(sl_node_t) + toplevel * sizeof(sl_node_t *));
+    node = (sl_node_t *)malloc(sizeof(sl_node_t) + toplevel * sizeof(sl_node_t *) + value_size);
   if (node == NULL) {
     perror("malloc");
     exit(1);
@@ -103,7 +105,8 @@ sl_node_t *sl_new_node(val_t val, sl_node_t *next, int toplevel, int transaction
 
 void sl_delete_node(sl_node_t *n)
 {
-  free(n);
+  if (!bench_bulk_owns(n))
+    free(n);
 }
 
 sl_intset_t *sl_set_new()
@@ -121,6 +124,36 @@ sl_intset_t *sl_set_new()
   return set;
 }
 
+/*
+ * Fills an empty set with n sorted keys as a perfect skip list: the i-th
+ * node (from 1) rises to level 1 + ctz(i), so that each level holds every
+ * other node of the level below. Nodes are allocated in key order.
+ */
+void sl_set_bulk_build(sl_intset_t *set, const val_t *keys, long n)
+{
+  sl_node_t *preds[32], *node, *tail = set->head->next[0];
+  long i;
+  int l, j;
+
+  for (j = 0; j < levelmax; j++)
+    preds[j] = set->head;
+  for (i = 1; i <= n; i++) {
+    l = 1 + __builtin_ctzl((unsigned long)i);
+    if (l > (int)levelmax)
+      l = (levelmax > 0 ? levelmax : 1);
+    node = (sl_node_t *)bench_bulk_alloc(sizeof(sl_node_t) + l * sizeof(sl_node_t *));
+    node->val = keys[i - 1];
+    node->toplevel = l;
+    node->deleted = 0;
+    for (j = 0; j < l; j++) {
+      preds[j]->next[j] = node;
+      preds[j] = node;
+    }
+  }
+  for (j = 0; j < levelmax; j++)
+    preds[j]->next[j] = tail;
+}
+
 void sl_set_delete(sl_intset_t *set)
 {
   sl_node_t *node, *next;
@@ -60,6 +60,7 @@ extern __thread unsigned int *rng_seed;
 extern pthread_key_t rng_seed_key;
 #endif /* ! TLS */
 extern unsigned int levelmax;
+extern unsigned int value_size;
 
 #define TRANSACTIONAL                   d->unit_tx
 
@@ -75,6 +76,9 @@ typedef struct sl_node {
   struct sl_node *next[1];
 } sl_node_t;
 
+/* In map mode, value_size bytes of value follow the next pointers */
+#define sl_node_value(n)                ((val_t *)&(n)->next[(n)->toplevel])
+
 typedef struct sl_intset {
   sl_node_t *head;
 } sl_intset_t;
@@ -87,5 +91,6 @@ sl_node_t *sl_new_node(val_t val, sl_node_t *next, int toplevel, int transaction
 void sl_delete_node(sl_node_t *n);
 
 sl_intset_t *sl_set_new();
+void sl_set_bulk_build(sl_intset_t *set, const val_t *keys, long n);
 void sl_set_delete(sl_intset_t *set);
 unsigned long sl_set_size(sl_intset_t *set);
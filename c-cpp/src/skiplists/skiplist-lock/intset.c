@@ -28,6 +28,11 @@ int sl_contains(sl_intset_t *set, val_t val, int transactional)
 	return optimistic_find(set, val);
 }
 
+long sl_range(sl_intset_t *set, val_t lo, val_t hi, val_t *keys)
+{
+	return optimistic_range(set, lo, hi, keys);
+}
+
 int sl_add(sl_intset_t *set, val_t val, int transactional)
 {  
 	return optimistic_insert(set, val);
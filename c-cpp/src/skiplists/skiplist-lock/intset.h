@@ -24,5 +24,6 @@
 #include "optimistic.h"
 
 int sl_contains(sl_intset_t *set, val_t val, int transactional);
+long sl_range(sl_intset_t *set, val_t lo, val_t hi, val_t *keys);
 int sl_add(sl_intset_t *set, val_t val, int transactional);
 int sl_remove(sl_intset_t *set, val_t val, int transactional);
@@ -28,8 +28,6 @@
 
 #include "optimistic.h"
 
-unsigned int levelmax;
-
 inline int ok_to_delete(sl_node_t *node, int found) {
   return (node->fullylinked && ((node->toplevel-1) == found) && !node->marked);
 }
@@ -78,6 +76,37 @@ int optimistic_find(sl_intset_t *set, val_t val) {
   return result;
 }
 
+/*
+ * Function optimistic_range scans the bottom level from the first node not 
+ * lower than lo, without locking. A node counts if it is fully linked and 
+ * not marked when the scan reaches it, so the scan is weakly consistent: 
+ * updates behind or ahead of it may or may not be seen.
+ */
+long optimistic_range(sl_intset_t *set, val_t lo, val_t hi, val_t *keys) {
+  long n = 0;
+  int i;
+  sl_node_t *pred, *curr;
+  ptst_t *ptst = ptst_critical_enter();
+
+  pred = set->head;
+  for (i = (pred->toplevel - 1); i >= 0; i--) {
+    curr = pred->next[i];
+    while (lo > curr->val) {
+      pred = curr;
+      curr = pred->next[i];
+    }
+  }
+  for (; curr->val <= hi; curr = curr->next[0]) {
+    if (curr->fullylinked && !curr->marked) {
+      if (keys != NULL)
+        keys[n] = curr->val;
+      n++;
+    }
+  }
+  ptst_critical_exit(ptst);
+  return n;
+}
+
 /*
  * Function unlock_levels is an helper function for the insert and delete 
  * functions.
@@ -27,5 +27,6 @@
 #include "skiplist-lock.h"
 
 int optimistic_find(sl_intset_t *set, val_t val);
+long optimistic_range(sl_intset_t *set, val_t lo, val_t hi, val_t *keys);
 int optimistic_insert(sl_intset_t *set, val_t val);
 int optimistic_delete(sl_intset_t *set, val_t val);
@@ -143,10 +143,10 @@ void sl_set_delete(sl_intset_t *set, ptst_t *ptst)
 
 int sl_set_size(sl_intset_t *set)
 {
-	int size = -1;
+	int size = 0;
 	sl_node_t *node;
 	
-	/* We have at least 2 elements */
+	/* Skip the head sentinel, stop before the tail one */
 	node = set->head->next[0];
 	while (node->next[0] != NULL) {
 		if (node->fullylinked && !node->marked)
@@ -33,6 +33,7 @@
 #include <stdint.h>
 
 #include <atomic_ops.h>
+#include "bench.h"
 #include "common.h"
 #include "ptst.h"
 #include "garbagecoll.h"
@@ -78,13 +79,13 @@ typedef intptr_t val_t;
 typedef pthread_mutex_t ptlock_t;
 #  define INIT_LOCK(lock)		pthread_mutex_init(lock, NULL);
 #  define DESTROY_LOCK(lock)		pthread_mutex_destroy(lock)
-#  define LOCK(lock)			pthread_mutex_lock(lock)
+#  define LOCK(lock)			bench_locked(pthread_mutex_lock(lock))
 #  define UNLOCK(lock)			pthread_mutex_unlock(lock)
 #else
 typedef pthread_spinlock_t ptlock_t;
 #  define INIT_LOCK(lock)		pthread_spin_init(lock, PTHREAD_PROCESS_PRIVATE);
 #  define DESTROY_LOCK(lock)		pthread_spin_destroy(lock)
-#  define LOCK(lock)			pthread_spin_lock(lock)
+#  define LOCK(lock)			bench_locked(pthread_spin_lock(lock))
 #  define UNLOCK(lock)			pthread_spin_unlock(lock)
 #endif
 
@@ -1,6 +1,6 @@
 
 /*************************************************************************************************/
-int perform_one_insert_window_operation(thread_data_t* data, seekRecord_t * R, size_t newKey){
+int perform_one_insert_window_operation(lfbst_thread_data_t* data, seekRecord_t * R, size_t newKey){
   node_t *newInt ;
 	node_t *newLeaf;
   if(data->recycledNodes.empty()){
@@ -63,7 +63,7 @@ int perform_one_insert_window_operation(thread_data_t* data, seekRecord_t * R, s
 
 /*************************************************************************************************/
 
-int perform_one_delete_window_operation(thread_data_t* data, seekRecord_t * R, size_t key){
+int perform_one_delete_window_operation(lfbst_thread_data_t* data, seekRecord_t * R, size_t key){
   
   AO_t pS;
 	
@@ -100,7 +100,7 @@ int perform_one_delete_window_operation(thread_data_t* data, seekRecord_t * R, s
 }
 
 
-seekRecord_t * insseek(thread_data_t * data, size_t key, int op){
+seekRecord_t * insseek(lfbst_thread_data_t * data, size_t key, int op){
 	
 	node_t * gpar = NULL; // last node (ancestor of parent on access path) whose child pointer field is unmarked
 	node_t * par = data->rootOfTree;
@@ -182,7 +182,7 @@ seekRecord_t * insseek(thread_data_t * data, size_t key, int op){
 }
 
 
-seekRecord_t * delseek(thread_data_t * data, size_t key, int op){
+seekRecord_t * delseek(lfbst_thread_data_t * data, size_t key, int op){
 	node_t * gpar = NULL; // last node (ancestor of parent on access path) whose child pointer field is unmarked
 	node_t * par = data->rootOfTree;
 	node_t * leaf;
@@ -265,7 +265,7 @@ seekRecord_t * delseek(thread_data_t * data, size_t key, int op){
 }
 
 
-seekRecord_t * secondary_seek(thread_data_t * data, size_t key, seekRecord_t * sr){
+seekRecord_t * secondary_seek(lfbst_thread_data_t * data, size_t key, seekRecord_t * sr){
 	
 	node_t * flaggedLeaf = (node_t *)get_addr(sr->pL);
 	node_t * gpar = NULL; // last node (ancestor of parent on access path) whose child pointer field is unmarked
@@ -343,7 +343,7 @@ seekRecord_t * secondary_seek(thread_data_t * data, size_t key, seekRecord_t * s
   return R;
 }
 
-bool search(thread_data_t * data, size_t key){
+bool search(lfbst_thread_data_t * data, size_t key){
 	
 	node_t * cur = (node_t *)get_addr(data->rootOfTree->child.AO_val1);
 	size_t lastKey;	
@@ -359,7 +359,7 @@ bool search(thread_data_t * data, size_t key){
 //-------------------------------------------------------------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------------------------------------------------------------
 
-int help_conflicting_operation (thread_data_t * data, seekRecord_t * R){
+int help_conflicting_operation (lfbst_thread_data_t * data, seekRecord_t * R){
 
 	if(is_flagged(R->pL)){
 		// leaf node is flagged for deletion by another process.
@@ -431,7 +431,7 @@ int help_conflicting_operation (thread_data_t * data, seekRecord_t * R){
 //-------------------------------------------------------------------------------------------------------------------------------------------------------
 
 
-int inject(thread_data_t * data, seekRecord_t * R, int op){
+int inject(lfbst_thread_data_t * data, seekRecord_t * R, int op){
 	
 		// pL is free
 		
@@ -452,7 +452,7 @@ int inject(thread_data_t * data, seekRecord_t * R, int op){
 		return result;
 }
 
-bool insert(thread_data_t * data, size_t key){
+bool insert(lfbst_thread_data_t * data, size_t key){
   int injectResult;
 	
 	while(true){
@@ -480,7 +480,7 @@ bool insert(thread_data_t * data, size_t key){
 	// execute insert window operation.	
 } 
 
-bool delete_node(thread_data_t * data, size_t key){
+bool delete_node(lfbst_thread_data_t * data, size_t key){
 	int injectResult;
 	
 	while(true){
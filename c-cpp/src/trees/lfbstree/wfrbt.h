@@ -40,42 +40,16 @@ typedef struct seekRecord{
   bool isLeftUM; // is  last unmarked node's child on access path the left child of  the last unmarked node?
 } seekRecord_t;
 
-typedef struct barrier {
-	pthread_cond_t complete;
-	pthread_mutex_t mutex;
-	int count;
-	int crossing;
-} barrier_t;
-
-typedef uintptr_t val_t;
-
-typedef struct thread_data {
-  val_t first;
-  long range;
-  int update;
-  int alternate;
-  int effective;
+/* Per-thread state the tree operations work on */
+typedef struct lfbst_thread_data {
   int id;
-  unsigned long numThreads;
-  unsigned long nb_add;
   unsigned long nb_added;
-  unsigned long nb_remove;
   unsigned long nb_removed;
-  unsigned long nb_contains;
-  unsigned long nb_found;
-  unsigned long ops;
-  unsigned int seed;
-  double search_frac;
-  double insert_frac;
-  double delete_frac;
-  long keyspace1_size;
   node_t* rootOfTree;
-  barrier_t *barrier;
   std::vector<node_t *> recycledNodes;
   seekRecord_t * sr; // seek record
   seekRecord_t * ssr; // secondary seek record
-
-} thread_data_t;
+} lfbst_thread_data_t;
 
 
 inline void *xmalloc(size_t size) {
@@ -89,9 +63,9 @@ inline void *xmalloc(size_t size) {
 
 
 // Forward declaration of window transactions
-int perform_one_delete_window_operation(thread_data_t* data, seekRecord_t * R, size_t key);
+int perform_one_delete_window_operation(lfbst_thread_data_t* data, seekRecord_t * R, size_t key);
 
-int perform_one_insert_window_operation(thread_data_t* data, seekRecord_t * R, size_t newKey);
+int perform_one_insert_window_operation(lfbst_thread_data_t* data, seekRecord_t * R, size_t newKey);
 
 
 /* ################################################################### *
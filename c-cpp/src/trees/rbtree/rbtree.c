@@ -81,6 +81,7 @@
 
 
 #include "rbtree.h"
+#include "bench.h"
 
 /* =============================================================================
  * DECLARATION OF TM_CALLABLE FUNCTIONS
@@ -1265,7 +1266,9 @@ static void
 releaseNode (node_t* n)
 {
 #ifndef SIMULATOR
-    free(n);
+    if (!bench_bulk_owns(n)) {
+        free(n);
+    }
 #endif    
 }
 
@@ -1277,7 +1280,9 @@ releaseNode (node_t* n)
 static void
 TMreleaseNode  (TM_ARGDECL  node_t* n)
 {
-    TM_FREE(n);
+    if (!bench_bulk_owns(n)) {
+        TM_FREE(n);
+    }
 }
 
 
@@ -1359,6 +1364,58 @@ TMgetNode (TM_ARGDECL_ALONE)
 }
 
 
+/* =============================================================================
+ * buildSubtree
+ * -- Builds the balanced subtree of keys[lo..hi] with its nodes allocated in
+ *    key order. Nodes at depth redDepth, the incomplete bottom level if any,
+ *    are red and all the others black.
+ * =============================================================================
+ */
+static node_t*
+buildSubtree (void* const* keys, long lo, long hi, long depth, long redDepth,
+              node_t* parent)
+{
+    node_t* n;
+    node_t* l;
+    long mid;
+
+    if (lo > hi) {
+        return NULL;
+    }
+    mid = lo + (hi - lo) / 2;
+    l = buildSubtree(keys, lo, mid - 1, depth + 1, redDepth, NULL);
+    n = (node_t*)bench_bulk_alloc(sizeof(*n));
+    n->k = keys[mid];
+    n->v = keys[mid];
+    n->p = parent;
+    n->l = l;
+    n->c = ((depth == redDepth) ? RED : BLACK);
+    if (l != NULL) {
+        l->p = n;
+    }
+    n->r = buildSubtree(keys, mid + 1, hi, depth + 1, redDepth, n);
+    return n;
+}
+
+
+/* =============================================================================
+ * rbtree_bulk_build
+ * -- Fills an empty tree with n distinct keys in increasing order, each
+ *    mapped to itself
+ * =============================================================================
+ */
+void
+rbtree_bulk_build (rbtree_t* r, void* const* keys, long n)
+{
+    long redDepth = 0;
+
+    while ((2L << redDepth) <= n + 1) {
+        redDepth++;
+    }
+    r->root = buildSubtree(keys, 0, n - 1, 0, redDepth, NULL);
+}
+
+
 /* =============================================================================
  * rbtree_insert
  * -- Returns TRUE on success
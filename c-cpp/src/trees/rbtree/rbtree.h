@@ -171,6 +171,15 @@ void
 rbtree_free (rbtree_t* r);
 
 
+/* =============================================================================
+ * rbtree_bulk_build
+ * -- Fills an empty tree with n distinct keys in increasing order
+ * =============================================================================
+ */
+void
+rbtree_bulk_build (rbtree_t* r, void* const* keys, long n);
+
+
 /* =============================================================================
  * TMrbtree_free
  * =============================================================================
@@ -23,6 +23,7 @@
  */
 
 #include "intset.h"
+#include "bench.h"
 #define CHECK_FIRST
 
 #ifdef NO_UNITLOADS
@@ -285,6 +286,59 @@ void rec_seq_ss(avl_node_t *node, int *size) {
   return;
 }
 
+/*
+ * Stores the keys in [lo, hi] into keys, or only counts them if keys is
+ * NULL. The whole scan is one normal transaction so it is atomic.
+ */
+long avl_range(avl_intset_t *set, val_t lo, val_t hi, val_t *keys) {
+  long n = 0;
+
+#ifdef SEQUENTIAL
+  rec_range(set->root->left, lo, hi, keys, &n);
+#elif defined TINY10B
+  TX_START(NL);
+  n = 0;
+  rec_range((avl_node_t *)TX_LOAD(&set->root->left), lo, hi, keys, &n);
+  TX_END;
+#endif
+
+  return n;
+}
+
+/* In-order walk of the subtrees that overlap [lo, hi] */
+void rec_range(avl_node_t *node, val_t lo, val_t hi, val_t *keys, long *n) {
+  if(node == NULL) {
+    return;
+  }
+#ifdef SEQUENTIAL
+  if(node->key > lo) {
+    rec_range(node->left, lo, hi, keys, n);
+  }
+  if(node->key >= lo && node->key <= hi && !node->deleted) {
+    if(keys != NULL) {
+      keys[*n] = node->key;
+    }
+    (*n)++;
+  }
+  if(node->key < hi) {
+    rec_range(node->right, lo, hi, keys, n);
+  }
+#elif defined TINY10B
+  if(node->key > lo) {
+    rec_range((avl_node_t *)TX_LOAD(&node->left), lo, hi, keys, n);
+  }
+  if(node->key >= lo && node->key <= hi && !TX_LOAD(&node->deleted)) {
+    if(keys != NULL) {
+      keys[*n] = node->key;
+    }
+    (*n)++;
+  }
+  if(node->key < hi) {
+    rec_range((avl_node_t *)TX_LOAD(&node->right), lo, hi, keys, n);
+  }
+#endif
+}
+
 #if defined(MICROBENCH)
 int avl_remove(avl_intset_t *set, val_t key, int transactional, int id)
 #else
@@ -362,7 +416,8 @@ int avl_req_seq_delete(avl_node_t *parent, avl_node_t *node, val_t key, int go_l
 	    free(node->bnode);
 	  }
 #endif
-	  free(node);
+	  if (!bench_bulk_owns(node))
+	    free(node);
 	  *success = 1;
 	  return 1;
 	} else if(node->right == NULL) {
@@ -399,7 +454,8 @@ int avl_req_seq_delete(avl_node_t *parent, avl_node_t *node, val_t key, int go_l
 	    free(node->bnode);
 	  }
 #endif
-	  free(node);
+	  if (!bench_bulk_owns(node))
+	    free(node);
 	  *success = 1;
 	  return 1;
 	} else {
@@ -442,7 +498,8 @@ int avl_req_seq_delete(avl_node_t *parent, avl_node_t *node, val_t key, int go_l
 	    free(node->bnode);
 	  }
 #endif
-	  free(node);
+	  if (!bench_bulk_owns(node))
+	    free(node);
 	  *success = 1;
 	  return avl_seq_propogate(parent, succs, go_left);
 	}
@@ -1500,7 +1557,8 @@ int remove_node(avl_node_t *parent, avl_node_t *place) {
 #endif
 #endif
 	  }
-	  FREE(place, sizeof(avl_node_t));
+	  if (!bench_bulk_owns(place))
+	    FREE(place, sizeof(avl_node_t));
 	  // Should update parent heights?
 	  ret = 2;
 	}
@@ -2896,7 +2954,8 @@ void do_maintenance(avl_intset_t *tree) {
     (t_nb_trans) = tmp;
     next = tree->free_list->next;
     while(next != NULL) {
-      free(next->to_free);
+      if (!bench_bulk_owns(next->to_free))
+	free(next->to_free);
       tmp_item = next;
       next = next->next;
       free(tmp_item);
@@ -2907,7 +2966,7 @@ void do_maintenance(avl_intset_t *tree) {
     //free the ones from your own main thread
     next = tree->t_free_list[id]->next;
     while(next != NULL) {
-      if(next->to_free != NULL) {
+      if(next->to_free != NULL && !bench_bulk_owns(next->to_free)) {
 	free(next->to_free);
       }
       tmp_item = next;
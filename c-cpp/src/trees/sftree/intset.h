@@ -44,6 +44,8 @@ int avl_remove(avl_intset_t *set, val_t key, int transactional);
 
 int avl_move(avl_intset_t *set, int val1, int val2, int transactional, int id);
 int avl_snapshot(avl_intset_t *set, int transactional, int id);
+long avl_range(avl_intset_t *set, val_t lo, val_t hi, val_t *keys);
+void rec_range(avl_node_t *node, val_t lo, val_t hi, val_t *keys, long *n);
 
 
 
@@ -23,6 +23,7 @@
  */
 
 #include "sftree.h"	
+#include "bench.h"
 
 int floor_log_2(unsigned int n) {
   int pos = 0;
@@ -134,14 +135,16 @@ void avl_delete_node_free(avl_node_t *node, int transactional)
       FREE(node->bnode, sizeof(balance_node_t));
     }
 #endif
-    FREE(node, sizeof(avl_node_t));
+    if (!bench_bulk_owns(node))
+      FREE(node, sizeof(avl_node_t));
   } else {
 #ifdef SEPERATE_BALANCE
     if(node->bnode != NULL) {
       free(node->bnode);
     }
 #endif
-    free(node);
+    if (!bench_bulk_owns(node))
+      free(node);
   }
 }
 
@@ -262,6 +265,56 @@ avl_intset_t *avl_set_new_alloc(int transactional, long nb_threads)
   return set;
 }
 
+/*
+ * Build the balanced subtree of keys[lo..hi], allocating its nodes in
+ * key order, and return its root and height.
+ */
+static avl_node_t *avl_bulk_subtree(const val_t *keys, long lo, long hi, val_t *height)
+{
+  avl_node_t *node, *left;
+  val_t lefth, righth;
+  long mid;
+
+  if (lo > hi) {
+    *height = 0;
+    return NULL;
+  }
+  mid = lo + (hi - lo) / 2;
+  left = avl_bulk_subtree(keys, lo, mid - 1, &lefth);
+  node = (avl_node_t *)bench_bulk_alloc(sizeof(avl_node_t));
+  node->key = keys[mid];
+  node->val = keys[mid];
+  node->deleted = 0;
+  node->removed = 0;
+  node->left = left;
+  node->right = avl_bulk_subtree(keys, mid + 1, hi, &righth);
+  *height = 1 + (lefth > righth ? lefth : righth);
+#ifdef SEPERATE_BALANCE
+  node->bnode = NULL;
+#else
+  node->lefth = lefth;
+  node->righth = righth;
+  node->localh = *height;
+#endif
+
+  return node;
+}
+
+/*
+ * Fill an empty set with n distinct keys in increasing order, as a
+ * perfectly balanced tree whose nodes come from bench_bulk_alloc().
+ */
+void avl_set_bulk_build(avl_intset_t *set, const val_t *keys, long n)
+{
+  val_t height;
+
+  set->root->left = avl_bulk_subtree(keys, 0, n - 1, &height);
+#ifndef SEPERATE_BALANCE
+  set->root->lefth = height;
+  set->root->localh = 1 + height;
+#endif
+}
+
 void avl_set_delete(avl_intset_t *set)
 {
 
@@ -338,6 +338,7 @@ void avl_delete_node_free(avl_node_t *node, int transactional);
 avl_intset_t *avl_set_new();
 avl_intset_t *avl_set_new_alloc(int transactional, long nb_threads);
 
+void avl_set_bulk_build(avl_intset_t *set, const val_t *keys, long n);
 void avl_set_delete(avl_intset_t *set);
 void avl_set_delete_node(avl_node_t *node);
 
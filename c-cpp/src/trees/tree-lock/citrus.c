@@ -3,6 +3,10 @@
 #include <pthread.h>
 #include "citrus.h" 
 #include "urcu.h"
+#include "bench.h"
+
+/* Lock holders may be descheduled on purpose, see bench_preempt() */
+#define LOCK(lock) bench_locked(pthread_mutex_lock(lock))
 
 /**
  * Copyright 2014 Maya Arbel (mayaarl [at] cs [dot] technion [dot] ac [dot] il).
@@ -112,7 +116,7 @@ bool insert(node root, int key, int value){
         tag = prev->tag[direction];
 		urcu_read_unlock();
         if (curr!=NULL) return false;
-        pthread_mutex_lock(&(prev->lock));
+        LOCK(&(prev->lock));
         if( validate(prev,tag,curr,direction) ){
             node new = newNode(key); 
 			prev->child[direction]=new;
@@ -150,8 +154,8 @@ bool delete(node root, int key){
             return false;
         }         
 		urcu_read_unlock();
-        pthread_mutex_lock(&(prev->lock));
-        pthread_mutex_lock(&(curr->lock));
+        LOCK(&(prev->lock));
+        LOCK(&(curr->lock));
         if( !validate(prev,0,curr,direction) ){
             pthread_mutex_unlock(&(prev->lock));
             pthread_mutex_unlock(&(curr->lock));
@@ -188,16 +192,16 @@ bool delete(node root, int key){
             }		
         int succDirection = 1; 
         if (prevSucc != curr){
-            pthread_mutex_lock(&(prevSucc->lock));
+            LOCK(&(prevSucc->lock));
             succDirection = 0;
         } 		
-        pthread_mutex_lock(&(succ->lock));
+        LOCK(&(succ->lock));
         if (validate(prevSucc,0,succ, succDirection) && validate(succ,succ->tag[0],NULL, 0)){
             curr->marked=true;
             node new = newNode(succ->key);
             new->child[0]=curr->child[0];
             new->child[1]=curr->child[1];
-            pthread_mutex_lock(&(new->lock)); 
+            LOCK(&(new->lock)); 
             prev->child[direction]=new;  
             urcu_synchronize();
             if(prev->child[direction] == NULL){